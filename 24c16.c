@@ -2,9 +2,6 @@
 
 #include "24c16.h"
 #include <stdio.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
@@ -77,38 +74,25 @@ char verify_checksum(t_eeprom_data* data)
 	}
 }
 
-int eeprom_open(t_24c16 *eeprom, unsigned char i2c_address)
+int eeprom_open(t_24c16 *eeprom, t_i2c_bus *bus, unsigned char i2c_address)
 {
 	// local variables
-	int fd;
-	char s;
+	unsigned char s;
 	int ret_code = 0;
-	char offset = 0x00;
+	unsigned char offset = 0x00;
 	
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
-	
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		ret_code = 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+	// check if I2C Bus is open
+	if (bus->fd < 0) {
+		fprintf(stderr, "I2C bus not open\n");
 		ret_code = 1;
 	}
 	
-	// assign file handle to sensor object
-	eeprom->fd = fd;
+	// assign bus to sensor object
+	eeprom->bus = bus;
 	eeprom->address = i2c_address;
 		
-	//write address offset to eeprom
-	if ((write(eeprom->fd, (void*)&offset, 1)) != 1) {				// Send register we want to read from	
-		//printf("Error writing to i2c slave (%s)\n", __func__);
-		ret_code = 1;
-	}
-	
-	if (read(eeprom->fd, &s, 1) != 1) {		// Read back data into buf[]
+	//write address offset to eeprom and read back one byte
+	if (i2c_bus_write_read(eeprom->bus, eeprom->address, &offset, 1, &s, 1) != 0) {
 		ret_code = 1;
 	}
 	
@@ -141,7 +125,7 @@ char eeprom_write(t_24c16 *eeprom, char *s, unsigned char offset, unsigned char
 		buf[1]=*(s);		
 		//printf("buf[1]: '%c'\n",buf[1]);
 		// Write data to EEPROM
-		if ((write(eeprom->fd, &buf[0], 2)) != 2) {				// Send register we want to read from	
+		if (i2c_bus_write(eeprom->bus, eeprom->address, &buf[0], 2) != 0) {	// Send register we want to read from	
 			printf("Error writing to i2c slave (%s)\n", __func__);
 			return(1);
 		}
@@ -156,13 +140,8 @@ char eeprom_write(t_24c16 *eeprom, char *s, unsigned char offset, unsigned char
 
 char eeprom_read(t_24c16 *eeprom, char *s, char offset, char count)
 {	
-	//write address offset to eeprom
-	if ((write(eeprom->fd, &offset, 1)) != 1) {				// Send register we want to read from	
-		printf("Error writing to i2c slave (%s)\n", __func__);
-		return(1);
-	}
-	
-	if (read(eeprom->fd, s, count) != count) {		// Read back data into buf[]
+	//write address offset to eeprom and read back data into s
+	if (i2c_bus_write_read(eeprom->bus, eeprom->address, (unsigned char *)&offset, 1, (unsigned char *)s, count) != 0) {
 		printf("Unable to read from slave\n");
 		return(1);
 	}
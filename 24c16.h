@@ -3,9 +3,11 @@
 // version 1 contained only ams5915 zero_offset
 #define EEPROM_DATA_VERSION 2
 
+#include "i2c_bus.h"
+
 // define struct for MS5611 sensor
 typedef struct {
-	int fd;
+	t_i2c_bus *bus;
 	unsigned char address;
 } t_24c16;
 
@@ -23,7 +25,7 @@ typedef struct {
 } t_eeprom_data;
 
 // prototypes
-int eeprom_open(t_24c16 *, unsigned char);
+int eeprom_open(t_24c16 *, t_i2c_bus *, unsigned char);
 char eeprom_write(t_24c16 *, char *, unsigned char, unsigned char);
 char eeprom_read(t_24c16 *, char *, char, char);
 int update_checksum(t_eeprom_data*);
@@ -0,0 +1,229 @@
+/*  
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS" 
+
+    This program is free software; you can redistribute it and/or 
+    modify it under the terms of the GNU General Public License 
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the 
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.	
+*/
+
+#include <math.h>
+#include "BaroInertialFilter.h"
+#include "vario.h"
+#include "timer.h"
+
+// longest prediction step, e.g. after a gap in IMU data
+#define MAX_PREDICT_DT	0.5f
+
+/**
+* @brief Reset filter to given pressure and rate of change
+* @param filter pointer to filter instance
+* @param z_abs pressure (hPa)
+* @param z_vel rate of change of pressure (hPa/s)
+* @return
+*
+* The noise parameters var_accel_, var_bias_ and var_z_abs_ must be set
+* after reset.
+* @date 17.10.2026 born
+*
+*/
+void BaroInertialFilter_reset(t_baroinertialfilter* filter, float z_abs, float z_vel)
+{
+	filter->x_abs_ = z_abs;
+	filter->x_vel_ = z_vel;
+	filter->x_bias_ = 0.0;
+
+	filter->p_abs_abs_ = 0.01;
+	filter->p_abs_vel_ = 0.0;
+	filter->p_abs_bias_ = 0.0;
+	filter->p_vel_vel_ = 0.01;
+	filter->p_vel_bias_ = 0.0;
+	filter->p_bias_bias_ = 0.01;
+
+	filter->var_accel_ = 0.0;
+	filter->var_bias_ = 0.0;
+	filter->var_z_abs_ = 0.0;
+
+	filter->started_ = 0;
+	filter->pending_ = 0;
+}
+
+/**
+* @brief Predict step with vertical acceleration as control input
+* @param filter pointer to filter instance
+* @param accel earth frame vertical acceleration without gravity (m/s^2, up)
+* @param dt time step (s)
+* @return
+*
+* The acceleration is converted to pressure units with the pressure
+* gradient of the standard atmosphere at the current pressure.
+* @date 17.10.2026 born
+*
+*/
+void BaroInertialFilter_predict(t_baroinertialfilter* filter, float accel, float dt)
+{
+	float dpdh = 1.0 / ComputeVario(filter->x_abs_, 1.0);
+	float var_u = filter->var_accel_ * dpdh * dpdh;
+	float var_b = filter->var_bias_ * dpdh * dpdh * dt;
+	float h = 0.5 * dt * dt;
+	float a;
+	float r0_abs, r0_vel, r0_bias;
+	float r1_vel, r1_bias;
+
+	if (dt <= 0.0)
+		return;
+
+	//Predict step
+	//update state estimate
+	a = accel * dpdh - filter->x_bias_;
+	filter->x_abs_ += filter->x_vel_ * dt + a * h;
+	filter->x_vel_ += a * dt;
+
+	// update state covariance, P = F P F' + Q
+	// F = [1 dt -dt^2/2; 0 1 -dt; 0 0 1]
+	r0_abs = filter->p_abs_abs_ + dt * filter->p_abs_vel_ - h * filter->p_abs_bias_;
+	r0_vel = filter->p_abs_vel_ + dt * filter->p_vel_vel_ - h * filter->p_vel_bias_;
+	r0_bias = filter->p_abs_bias_ + dt * filter->p_vel_bias_ - h * filter->p_bias_bias_;
+	r1_vel = filter->p_vel_vel_ - dt * filter->p_vel_bias_;
+	r1_bias = filter->p_vel_bias_ - dt * filter->p_bias_bias_;
+
+	filter->p_abs_abs_ = r0_abs + dt * r0_vel - h * r0_bias + h * h * var_u;
+	filter->p_abs_vel_ = r0_vel - dt * r0_bias + h * dt * var_u;
+	filter->p_abs_bias_ = r0_bias;
+	filter->p_vel_vel_ = r1_vel - dt * r1_bias + dt * dt * var_u;
+	filter->p_vel_bias_ = r1_bias;
+	filter->p_bias_bias_ += var_b;
+}
+
+/**
+* @brief Update step with pressure measurement
+* @param filter pointer to filter instance
+* @param z_abs pressure (hPa)
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void BaroInertialFilter_update(t_baroinertialfilter* filter, float z_abs)
+{
+	float p_abs_abs = filter->p_abs_abs_;
+	float p_abs_vel = filter->p_abs_vel_;
+	float p_abs_bias = filter->p_abs_bias_;
+	float y;
+	float s_inv;
+	float k_abs, k_vel, k_bias;
+
+	// Update step
+	y = z_abs - filter->x_abs_;					// Innovation
+	s_inv = 1.0 / (p_abs_abs + filter->var_z_abs_);	// Innovation precision
+	k_abs = p_abs_abs * s_inv;					// Kalman gain
+	k_vel = p_abs_vel * s_inv;
+	k_bias = p_abs_bias * s_inv;
+
+	// Update state estimate.
+	filter->x_abs_ += k_abs * y;
+	filter->x_vel_ += k_vel * y;
+	filter->x_bias_ += k_bias * y;
+
+	// Update state covariance.
+	filter->p_abs_abs_ -= k_abs * p_abs_abs;
+	filter->p_abs_vel_ -= k_abs * p_abs_vel;
+	filter->p_abs_bias_ -= k_abs * p_abs_bias;
+	filter->p_vel_vel_ -= k_vel * p_abs_vel;
+	filter->p_vel_bias_ -= k_vel * p_abs_bias;
+	filter->p_bias_bias_ -= k_bias * p_abs_bias;
+}
+
+/**
+* @brief Advance filter to time of accel sample
+* @param filter pointer to filter instance
+* @param t time of sample
+* @param accel earth frame vertical acceleration without gravity (m/s^2, up)
+* @return
+*
+* Pending pressure samples up to t are applied at their own time, the
+* acceleration is held constant in between.
+* @date 17.10.2026 born
+*
+*/
+void BaroInertialFilter_add_accel(t_baroinertialfilter* filter, const struct timespec* t, float accel)
+{
+	float dt;
+	int used = 0;
+	int i;
+
+	if (!filter->started_)
+	{
+		filter->t_ = *t;
+		filter->started_ = 1;
+		return;
+	}
+
+	// pressure samples until t
+	while (used < filter->pending_ && timespec_diff_ns(&filter->pending_t_[used], t) <= 0)
+	{
+		dt = timespec_diff_ns(&filter->pending_t_[used], &filter->t_) / 1e9;
+		if (dt > 0.0)
+		{
+			BaroInertialFilter_predict(filter, accel, dt < MAX_PREDICT_DT ? dt : MAX_PREDICT_DT);
+			filter->t_ = filter->pending_t_[used];
+		}
+		BaroInertialFilter_update(filter, filter->pending_z_[used]);
+		used++;
+	}
+
+	for (i = used; i < filter->pending_; i++)
+	{
+		filter->pending_t_[i - used] = filter->pending_t_[i];
+		filter->pending_z_[i - used] = filter->pending_z_[i];
+	}
+	filter->pending_ -= used;
+
+	dt = timespec_diff_ns(t, &filter->t_) / 1e9;
+	if (dt > 0.0)
+	{
+		BaroInertialFilter_predict(filter, accel, dt < MAX_PREDICT_DT ? dt : MAX_PREDICT_DT);
+		filter->t_ = *t;
+	}
+}
+
+/**
+* @brief Queue pressure measurement until IMU data of its time is there
+* @param filter pointer to filter instance
+* @param t time of measurement
+* @param z_abs pressure (hPa)
+* @return
+*
+* If the queue is full, the oldest sample is applied at the current state.
+* @date 17.10.2026 born
+*
+*/
+void BaroInertialFilter_add_pressure(t_baroinertialfilter* filter, const struct timespec* t, float z_abs)
+{
+	int i;
+
+	if (filter->pending_ == BARO_PENDING_MAX)
+	{
+		BaroInertialFilter_update(filter, filter->pending_z_[0]);
+		for (i = 1; i < BARO_PENDING_MAX; i++)
+		{
+			filter->pending_t_[i - 1] = filter->pending_t_[i];
+			filter->pending_z_[i - 1] = filter->pending_z_[i];
+		}
+		filter->pending_--;
+	}
+
+	filter->pending_t_[filter->pending_] = *t;
+	filter->pending_z_[filter->pending_] = z_abs;
+	filter->pending_++;
+}
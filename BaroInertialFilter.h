@@ -0,0 +1,65 @@
+/*  
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS" 
+
+    This program is free software; you can redistribute it and/or 
+    modify it under the terms of the GNU General Public License 
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the 
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.	
+*/
+
+#ifndef BAROINERTIALFILTER_H
+#define BAROINERTIALFILTER_H
+
+#include <time.h>
+
+// pressure samples waiting for IMU data of the same time
+#define BARO_PENDING_MAX	16	// pressure samples between two IMU batches, e.g. 100 Hz baro with 10 Hz polling
+
+// default noise parameters
+#define BARO_INERTIAL_ACCEL_VAR		0.1		// m^2/s^4
+#define BARO_INERTIAL_BIAS_VAR		0.0001	// m^2/s^5
+#define BARO_INERTIAL_PRESSURE_VAR	0.0025	// hPa^2
+
+// 3-state Kalman filter of pressure, driven by vertical acceleration
+typedef struct {
+	float x_abs_;		// pressure (hPa)
+	float x_vel_;		// rate of change of pressure (hPa/s)
+	float x_bias_;		// bias of the accel input, in pressure units (hPa/s^2)
+
+	// Covariance matrix for the state
+	float p_abs_abs_;
+	float p_abs_vel_;
+	float p_abs_bias_;
+	float p_vel_vel_;
+	float p_vel_bias_;
+	float p_bias_bias_;
+
+	float var_accel_;	// variance of vertical accel input (m^2/s^4)
+	float var_bias_;	// random walk of accel bias (m^2/s^5)
+	float var_z_abs_;	// variance of pressure measurement (hPa^2)
+
+	// time of state, pressure samples newer than that are pending
+	struct timespec t_;
+	int started_;
+	struct timespec pending_t_[BARO_PENDING_MAX];
+	float pending_z_[BARO_PENDING_MAX];
+	int pending_;
+} t_baroinertialfilter;
+
+void BaroInertialFilter_reset(t_baroinertialfilter*, float, float);
+void BaroInertialFilter_predict(t_baroinertialfilter*, float, float);
+void BaroInertialFilter_update(t_baroinertialfilter*, float);
+void BaroInertialFilter_add_accel(t_baroinertialfilter*, const struct timespec*, float);
+void BaroInertialFilter_add_pressure(t_baroinertialfilter*, const struct timespec*, float);
+
+#endif
@@ -20,42 +20,31 @@
 #include "ads1110.h"
 #include <time.h>
 #include <stdio.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <math.h>
 #include <time.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
 #include <errno.h>
 #include <string.h>
+#include "i2c_bus.h"
 #include "def.h"
 
 extern int g_debug;
 extern FILE *fp_console;
 
-int ads1110_open(t_ads1110 *sensor, unsigned char i2c_address)
+int ads1110_open(t_ads1110 *sensor, t_i2c_bus *bus, unsigned char i2c_address)
 {
 	// local variables
-	int fd;
 	unsigned char buf[10]={0x00};
 	
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
-	
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-		
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+	// check if I2C Bus is open
+	if (bus->fd < 0) {
+		fprintf(stderr, "I2C bus not open\n");
 		sensor->present = 0;
 		return 1;
 	}
 	
 	// Try to read from sensor to check if it present
-	if (read(fd, buf, 3) != 3)
+	if (i2c_bus_read(bus, i2c_address, buf, 3) != 0)
 	{
 		sensor->present = 0;
 		return (1);
@@ -63,8 +52,8 @@ int ads1110_open(t_ads1110 *sensor, unsigned char i2c_address)
 	
 	if (g_debug > 0) printf("Opened ADS1110 on 0x%x\n", i2c_address);
 	
-	// assign file handle to sensor object
-	sensor->fd = fd;
+	// assign bus to sensor object
+	sensor->bus = bus;
 	sensor->address = i2c_address;
 	sensor->present = 1;
 	return (0);
@@ -82,18 +71,22 @@ int ads1110_init(t_ads1110 *sensor)
 
 int ads1110_measure(t_ads1110 *sensor)
 {
-	//variables
-	//struct timespec sample_time;
-	unsigned char buf[10]={0x00};
-  //int digoutp;
-
-	
-	if (read(sensor->fd, buf, 3) != 3) {								// Read back data into buf[]
+	if (i2c_bus_read(sensor->bus, sensor->address, sensor->buf, 3) != 0) {		// Read back data into buf[]
 		printf("Unable to read from slave\n");
 		return(1);
 	}
 	
-	sensor->voltage_raw = (buf[0] << 8) + buf[1];
+	return (ads1110_decode(sensor));
+}
+
+int ads1110_batch_measure(t_ads1110 *sensor, t_i2c_batch *batch)
+{
+	return (i2c_batch_add_read(batch, sensor->address, sensor->buf, 3));
+}
+
+int ads1110_decode(t_ads1110 *sensor)
+{
+	sensor->voltage_raw = (sensor->buf[0] << 8) + sensor->buf[1];
 
 	ddebug_print("%s @ 0x%x: voltage_raw=%d\n", __func__, sensor->address, sensor->voltage_raw);
 
@@ -17,18 +17,23 @@
     along with this program; if not, see <http://www.gnu.org/licenses/>.	
 */
 
+#include "i2c_bus.h"
+
 // define struct for AMS5915 sensor
 typedef struct {
 	float voltage_factor;
 	int voltage_raw;
 	float voltage_converted;
-	int fd;
+	t_i2c_bus *bus;
 	unsigned char address;
 	unsigned char present;
+	unsigned char buf[3];		// result of batched transfers
 } t_ads1110;
 
 // prototypes
 int ads1110_init(t_ads1110 *);
 int ads1110_measure(t_ads1110 *);
 int ads1110_calculate(t_ads1110 *);
-int ads1110_open(t_ads1110 *, unsigned char);
\ No newline at end of file
+int ads1110_open(t_ads1110 *, t_i2c_bus *, unsigned char);
+int ads1110_batch_measure(t_ads1110 *, t_i2c_batch *);
+int ads1110_decode(t_ads1110 *);
\ No newline at end of file
@@ -0,0 +1,302 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ahrs_filter.h"
+#include <math.h>
+#include <string.h>
+
+static float inv_norm3(float x, float y, float z)
+{
+	float n = x * x + y * y + z * z;
+
+	if (n <= 0.0f)
+		return 0.0f;
+
+	return 1.0f / sqrtf(n);
+}
+
+/**
+* @brief Reset attitude filter
+* @param filter pointer to filter instance
+* @param type AHRS_FILTER_MADGWICK or AHRS_FILTER_MAHONY
+* @param gain correction gain, beta for Madgwick or 2*Kp for Mahony
+* @param bias_gain gyro bias gain, zeta for Madgwick or 2*Ki for Mahony, 0 disables bias estimation
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void ahrs_filter_init(t_ahrs_filter *filter, int type, float gain, float bias_gain)
+{
+	memset(filter, 0, sizeof(t_ahrs_filter));
+
+	filter->type = type;
+	filter->q[0] = 1.0f;
+	filter->gain = gain;
+	filter->bias_gain = bias_gain;
+	filter->settle_time = AHRS_FILTER_SETTLE_TIME;
+}
+
+/**
+* @brief Madgwick gradient descent step
+* @param q orientation
+* @param a normalised accel
+* @param m normalised mag or NULL
+* @param s corrective step, normalised
+* @return
+*
+* Gradient of the error between measured and expected direction of gravity
+* and, if available, of the earth magnetic field.
+* @date 17.10.2026 born
+*
+*/
+static void madgwick_step(const float *q, const float *a, const float *m, float *s)
+{
+	float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+	float ax = a[0], ay = a[1], az = a[2];
+	float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+	float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+	float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+	float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+	float recip;
+
+	if (m == NULL) {
+		float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+		float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+
+		s[0] = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+		s[1] = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+		s[2] = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+		s[3] = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+	}
+	else {
+		float mx = m[0], my = m[1], mz = m[2];
+		float _2q0mx = 2.0f * q0 * mx, _2q0my = 2.0f * q0 * my, _2q0mz = 2.0f * q0 * mz;
+		float _2q1mx = 2.0f * q1 * mx;
+		float _2q0q2 = 2.0f * q0q2, _2q2q3 = 2.0f * q2q3;
+		float hx, hy, _2bx, _2bz, _4bx, _4bz;
+		float ex, ey, ez, fx, fy, fz;
+
+		// reference direction of earth magnetic field
+		hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
+		hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+		_2bx = sqrtf(hx * hx + hy * hy);
+		_2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+		_4bx = 2.0f * _2bx;
+		_4bz = 2.0f * _2bz;
+
+		// objective function of gravity and mag
+		ex = 2.0f * q1q3 - _2q0q2 - ax;
+		ey = 2.0f * q0q1 + _2q2q3 - ay;
+		ez = 1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az;
+		fx = _2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+		fy = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+		fz = _2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz;
+
+		s[0] = -_2q2 * ex + _2q1 * ey - _2bz * q2 * fx + (-_2bx * q3 + _2bz * q1) * fy + _2bx * q2 * fz;
+		s[1] = _2q3 * ex + _2q0 * ey - 2.0f * _2q1 * ez + _2bz * q3 * fx + (_2bx * q2 + _2bz * q0) * fy + (_2bx * q3 - _4bz * q1) * fz;
+		s[2] = -_2q0 * ex + _2q3 * ey - 2.0f * _2q2 * ez + (-_4bx * q2 - _2bz * q0) * fx + (_2bx * q1 + _2bz * q3) * fy + (_2bx * q0 - _4bz * q2) * fz;
+		s[3] = _2q1 * ex + _2q2 * ey + (-_4bx * q3 + _2bz * q1) * fx + (-_2bx * q0 + _2bz * q2) * fy + _2bx * q1 * fz;
+	}
+
+	recip = s[0] * s[0] + s[1] * s[1] + s[2] * s[2] + s[3] * s[3];
+	if (recip <= 0.0f) {
+		s[0] = s[1] = s[2] = s[3] = 0.0f;
+		return;
+	}
+
+	recip = 1.0f / sqrtf(recip);
+	s[0] *= recip;
+	s[1] *= recip;
+	s[2] *= recip;
+	s[3] *= recip;
+}
+
+/**
+* @brief Madgwick filter update
+* @param filter pointer to filter instance
+* @param w gyro (rad/s), bias corrected on return
+* @param a normalised accel
+* @param m normalised mag or NULL
+* @param dt time step (s)
+* @param gain beta
+* @param bias_gain zeta
+* @return
+*
+* The gyro bias is integrated from the gyro error 2 * q^-1 x s, which is
+* the drift the gradient step corrects for.
+* @date 17.10.2026 born
+*
+*/
+static void madgwick_update(t_ahrs_filter *filter, float *w, const float *a, const float *m, float dt, float gain, float bias_gain)
+{
+	float *q = filter->q;
+	float s[4];
+	float qdot[4];
+	int i;
+
+	madgwick_step(q, a, m, s);
+
+	if (bias_gain > 0.0f) {
+		filter->gyro_bias[0] += 2.0f * (q[0] * s[1] - q[1] * s[0] - q[2] * s[3] + q[3] * s[2]) * dt * bias_gain;
+		filter->gyro_bias[1] += 2.0f * (q[0] * s[2] + q[1] * s[3] - q[2] * s[0] - q[3] * s[1]) * dt * bias_gain;
+		filter->gyro_bias[2] += 2.0f * (q[0] * s[3] - q[1] * s[2] + q[2] * s[1] - q[3] * s[0]) * dt * bias_gain;
+	}
+
+	for (i = 0; i < 3; i++)
+		w[i] -= filter->gyro_bias[i];
+
+	// rate of change of quaternion from gyro
+	qdot[0] = 0.5f * (-q[1] * w[0] - q[2] * w[1] - q[3] * w[2]);
+	qdot[1] = 0.5f * (q[0] * w[0] + q[2] * w[2] - q[3] * w[1]);
+	qdot[2] = 0.5f * (q[0] * w[1] - q[1] * w[2] + q[3] * w[0]);
+	qdot[3] = 0.5f * (q[0] * w[2] + q[1] * w[1] - q[2] * w[0]);
+
+	for (i = 0; i < 4; i++)
+		q[i] += (qdot[i] - gain * s[i]) * dt;
+}
+
+/**
+* @brief Mahony filter update
+* @param filter pointer to filter instance
+* @param w gyro (rad/s), bias corrected on return
+* @param a normalised accel
+* @param m normalised mag or NULL
+* @param dt time step (s)
+* @param gain 2*Kp
+* @param bias_gain 2*Ki
+* @return
+*
+* The integral of the error is the negative gyro bias.
+* @date 17.10.2026 born
+*
+*/
+static void mahony_update(t_ahrs_filter *filter, float *w, const float *a, const float *m, float dt, float gain, float bias_gain)
+{
+	float *q = filter->q;
+	float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+	float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+	float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+	float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+	float vx, vy, vz;
+	float e[3];
+	int i;
+
+	// estimated direction of gravity
+	vx = q1q3 - q0q2;
+	vy = q0q1 + q2q3;
+	vz = q0q0 - 0.5f + q3q3;
+
+	e[0] = a[1] * vz - a[2] * vy;
+	e[1] = a[2] * vx - a[0] * vz;
+	e[2] = a[0] * vy - a[1] * vx;
+
+	if (m != NULL) {
+		float hx, hy, bx, bz, wx, wy, wz;
+
+		// reference direction of earth magnetic field
+		hx = 2.0f * (m[0] * (0.5f - q2q2 - q3q3) + m[1] * (q1q2 - q0q3) + m[2] * (q1q3 + q0q2));
+		hy = 2.0f * (m[0] * (q1q2 + q0q3) + m[1] * (0.5f - q1q1 - q3q3) + m[2] * (q2q3 - q0q1));
+		bx = sqrtf(hx * hx + hy * hy);
+		bz = 2.0f * (m[0] * (q1q3 - q0q2) + m[1] * (q2q3 + q0q1) + m[2] * (0.5f - q1q1 - q2q2));
+
+		// estimated direction of magnetic field
+		wx = bx * (0.5f - q2q2 - q3q3) + bz * (q1q3 - q0q2);
+		wy = bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3);
+		wz = bx * (q0q2 + q1q3) + bz * (0.5f - q1q1 - q2q2);
+
+		e[0] += m[1] * wz - m[2] * wy;
+		e[1] += m[2] * wx - m[0] * wz;
+		e[2] += m[0] * wy - m[1] * wx;
+	}
+
+	for (i = 0; i < 3; i++) {
+		if (bias_gain > 0.0f)
+			filter->gyro_bias[i] -= bias_gain * e[i] * dt;
+
+		w[i] = w[i] - filter->gyro_bias[i] + gain * e[i];
+	}
+
+	q[0] += 0.5f * dt * (-q1 * w[0] - q2 * w[1] - q3 * w[2]);
+	q[1] += 0.5f * dt * (q0 * w[0] + q2 * w[2] - q3 * w[1]);
+	q[2] += 0.5f * dt * (q0 * w[1] - q1 * w[2] + q3 * w[0]);
+	q[3] += 0.5f * dt * (q0 * w[2] + q1 * w[1] - q2 * w[0]);
+}
+
+/**
+* @brief Update attitude filter with one gyro/accel sample
+* @param filter pointer to filter instance
+* @param gyro angular rate (rad/s)
+* @param accel acceleration, any unit
+* @param mag magnetic field, any unit, NULL or zero if not available
+* @param dt time since last update (s)
+* @return
+*
+* All vectors are in the same (body) frame. Without a valid accel
+* sample only the gyro is integrated.
+* @date 17.10.2026 born
+*
+*/
+void ahrs_filter_update(t_ahrs_filter *filter, const float *gyro, const float *accel, const float *mag, float dt)
+{
+	float w[3] = { gyro[0], gyro[1], gyro[2] };
+	float a[3], m[3];
+	const float *mp = NULL;
+	float gain = filter->gain;
+	float bias_gain = filter->bias_gain;
+	float recip;
+	int i;
+
+	if (filter->settle_time > 0.0f) {
+		filter->settle_time -= dt;
+		gain *= AHRS_FILTER_SETTLE_GAIN;
+		bias_gain = 0.0f;
+	}
+
+	recip = inv_norm3(accel[0], accel[1], accel[2]);
+	if (recip == 0.0f) {
+		gain = 0.0f;
+		bias_gain = 0.0f;
+	}
+
+	for (i = 0; i < 3; i++)
+		a[i] = accel[i] * recip;
+
+	if (mag != NULL) {
+		recip = inv_norm3(mag[0], mag[1], mag[2]);
+		if (recip > 0.0f) {
+			for (i = 0; i < 3; i++)
+				m[i] = mag[i] * recip;
+			mp = m;
+		}
+	}
+
+	if (filter->type == AHRS_FILTER_MAHONY)
+		mahony_update(filter, w, a, mp, dt, gain, bias_gain);
+	else
+		madgwick_update(filter, w, a, mp, dt, gain, bias_gain);
+
+	recip = filter->q[0] * filter->q[0] + filter->q[1] * filter->q[1]
+		+ filter->q[2] * filter->q[2] + filter->q[3] * filter->q[3];
+	recip = 1.0f / sqrtf(recip);
+	for (i = 0; i < 4; i++)
+		filter->q[i] *= recip;
+
+	filter->updates++;
+}
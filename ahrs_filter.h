@@ -0,0 +1,47 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AHRS_FILTER_H
+#define AHRS_FILTER_H
+
+// filter types
+#define AHRS_FILTER_MADGWICK	0
+#define AHRS_FILTER_MAHONY		1
+
+// after reset the filter runs with higher gain and without bias estimation,
+// so it converges from the initial orientation within a few seconds
+#define AHRS_FILTER_SETTLE_TIME	2.0f	// s
+#define AHRS_FILTER_SETTLE_GAIN	10.0f
+
+// define struct for software attitude filter on raw gyro, accel and mag
+typedef struct {
+	int type;
+	float q[4];					// orientation w, x, y, z
+	float gyro_bias[3];			// estimated gyro bias (rad/s)
+	float gain;					// beta (Madgwick) or 2*Kp (Mahony)
+	float bias_gain;			// zeta (Madgwick) or 2*Ki (Mahony)
+	float settle_time;			// s left with settle gain
+	unsigned long updates;
+} t_ahrs_filter;
+
+// prototypes
+void ahrs_filter_init(t_ahrs_filter *, int, float, float);
+void ahrs_filter_update(t_ahrs_filter *, const float *, const float *, const float *, float);
+
+#endif
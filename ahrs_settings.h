@@ -35,7 +35,14 @@
 
 #define AHRS_SAMPLE_RATE_HZ	10
 
-#define AHRS_YAW_MIX_FACTOR 4
+// time constant (s) of mag yaw mixing
+#define AHRS_YAW_TIME_CONSTANT 0.35f
+
+// gains of software fusion engines
+#define AHRS_MADGWICK_BETA	0.05f	// rad/s
+#define AHRS_MADGWICK_ZETA	0.02f	// gyro bias
+#define AHRS_MAHONY_KP		1.0f	// 2 * Kp
+#define AHRS_MAHONY_KI		0.05f	// 2 * Ki, gyro bias
 
 #define SYS_CONF_FILE "/boot/config.uEnv"
 
@@ -20,15 +20,13 @@
 #include "ams5915.h"
 #include <time.h>
 #include <stdio.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <math.h>
 #include <time.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
 #include <errno.h>
 #include <string.h>
+#include "i2c_bus.h"
 #include "def.h"
 
 extern int g_debug;
@@ -37,34 +35,25 @@ extern FILE *fp_console;
 /**
 * @brief Establish connection to AMS5915 pressure sensor
 * @param sensor pointer to sensor instance
+* @param bus pointer to shared I2C bus
 * @param i2c_address
 * @return result
 *
-* @date 24.03.2016 revised
+* @date 17.10.2026 revised
 *
 */ 
-int ams5915_open(t_ams5915 *sensor, unsigned char i2c_address)
+int ams5915_open(t_ams5915 *sensor, t_i2c_bus *bus, unsigned char i2c_address)
 {
-	// local variables
-	int fd;
-	
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
-	
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+	// check if I2C Bus is open
+	if (bus->fd < 0) {
+		fprintf(stderr, "I2C bus not open\n");
 		return 1;
 	}
 	
 	if (g_debug > 0) printf("Opened AMS5915 on 0x%x\n", i2c_address);
 	
-	// assign file handle to sensor object
-	sensor->fd = fd;
+	// assign bus to sensor object
+	sensor->bus = bus;
 	sensor->address = i2c_address;
 	return (0);
 }
@@ -100,16 +89,40 @@ int ams5915_init(t_ams5915 *sensor)
 */ 
 int ams5915_measure(t_ams5915 *sensor)
 {
-	//variables
-	uint8_t buf[10]={0x00};
-
-	if (read(sensor->fd, buf, 4) != 4) {								// Read back data into buf[]
+	if (i2c_bus_read(sensor->bus, sensor->address, sensor->buf, 4) != 0) {		// Read back data into buf[]
 		printf("Unable to read from slave\n");
 		return(1);
 	}
 	
-	sensor->digoutp = ((buf[0] & (0x3F)) << 8) + buf[1];
-	sensor->digoutT = ((buf[2] << 8) + (buf[3] & 0xE0)) >> 5;
+	return (ams5915_decode(sensor));
+}
+
+/**
+* @brief Add measurement read of AMS5915 pressure sensor to batch
+* @param sensor pointer to sensor instance
+* @param batch pointer to batch
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/ 
+int ams5915_batch_measure(t_ams5915 *sensor, t_i2c_batch *batch)
+{
+	return (i2c_batch_add_read(batch, sensor->address, sensor->buf, 4));
+}
+
+/**
+* @brief Extract raw pressure and temperature from AMS5915 read result
+* @param sensor pointer to sensor instance
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/ 
+int ams5915_decode(t_ams5915 *sensor)
+{
+	sensor->digoutp = ((sensor->buf[0] & (0x3F)) << 8) + sensor->buf[1];
+	sensor->digoutT = ((sensor->buf[2] << 8) + (sensor->buf[3] & 0xE0)) >> 5;
 	debug_print("%s @ 0x%x: digoutp=0x%x %d\n", __func__, sensor->address, sensor->digoutp, sensor->digoutp);
 	debug_print("%s @ 0x%x: digoutT=0x%x %d\n", __func__, sensor->address,sensor->digoutT, sensor->digoutT);
 	return(0);
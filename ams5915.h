@@ -19,12 +19,13 @@
 
 #include <time.h>
 #include <stdint.h>
+#include "i2c_bus.h"
 
 // variable definitions
 
 // define struct for AMS5915 sensor
 typedef struct {
-	int fd;
+	t_i2c_bus *bus;
 	unsigned char address;
 	uint16_t digoutpmin;
 	uint16_t digoutpmax;
@@ -38,10 +39,13 @@ typedef struct {
 	float linearity;
 	float offset;
 	int valid;
+	uint8_t buf[4];				// result of batched transfers
 } t_ams5915;
 
 // prototypes
 int ams5915_init(t_ams5915 *);
 int ams5915_measure(t_ams5915 *);
 int ams5915_calculate(t_ams5915 *);
-int ams5915_open(t_ams5915 *, unsigned char);
\ No newline at end of file
+int ams5915_open(t_ams5915 *, t_i2c_bus *, unsigned char);
+int ams5915_batch_measure(t_ams5915 *, t_i2c_batch *);
+int ams5915_decode(t_ams5915 *);
\ No newline at end of file
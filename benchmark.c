@@ -0,0 +1,1037 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "benchmark.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "timer.h"
+#include "mpu9150.h"
+#include "ahrs_settings.h"
+#include "KalmanFilter1d.h"
+#include "BaroInertialFilter.h"
+#include "vario.h"
+#include "nmea.h"
+#include "snapshot.h"
+#include "sample_ring.h"
+#include "gpio.h"
+
+#define BENCH_SAMPLE_RATE		200		// Hz
+#define BENCH_PACKETS			20		// FIFO packets per read
+#define BENCH_FUSION_UPDATES	60000	// 5 min of data at 200 Hz
+#define BENCH_GYRO_BIAS			16		// LSB, about 1 deg/s
+#define BENCH_ROTATION			2		// chip axes are body axes
+
+// vario: climb rate steps of a simulated flight, sampled like sensord does
+#define BENCH_VARIO_TIME		120		// s
+#define BENCH_VARIO_SETTLE		20		// s before statistics start
+#define BENCH_VARIO_IMU_RATE	100		// Hz
+#define BENCH_VARIO_BARO_RATE	20		// Hz
+#define BENCH_VARIO_IMU_READS	10		// Hz, IMU packets arrive in batches
+#define BENCH_VARIO_STEP		2.0f	// m/s
+#define BENCH_VARIO_RAMP		0.5f	// s
+#define BENCH_VARIO_PERIOD		10		// s between steps
+#define BENCH_VARIO_MAX_LAG		300		// in 10 ms steps
+#define BENCH_BARO_NOISE		0.015f	// hPa, MS5611 at OSR 4096
+#define BENCH_ACCEL_NOISE		0.2f	// m/s^2
+#define BENCH_ACCEL_BIAS		0.15f	// m/s^2
+
+// NMEA: golden check against the sprintf formatting, then timing
+#define BENCH_NMEA_RANDOM		200000	// random values per sentence type
+#define BENCH_NMEA_SENTENCES	100000	// sentences per timing run
+
+// shared memory snapshot: cost of one update/read, then latency to a reader
+#define BENCH_SNAPSHOT_LOOPS	1000000
+#define BENCH_SNAPSHOT_UPDATES	2000	// published by writer thread
+#define BENCH_SNAPSHOT_PERIOD	500000	// ns between updates
+
+// shared memory sample ring: cost per record, then overrun of a slow reader
+#define BENCH_RING_SLOTS		1024
+#define BENCH_RING_BATCH		512		// records written, then read
+#define BENCH_RING_RECORDS		1000000
+
+// local output: loopback TCP against Unix domain SOCK_SEQPACKET
+#define BENCH_SOCKET_MESSAGES	200000	// output ticks
+#define BENCH_SOCKET_BATCH		8		// ticks sent before the reader catches up
+
+// fake GPIO line: edge records written into a FIFO, whole and in pieces
+#define BENCH_GPIO_EVENTS		64		// fit into the pipe buffer at once
+#define BENCH_GPIO_SPLIT		7		// bytes per write, not a multiple of the record
+
+static unsigned long bench_seed = 1;
+
+// deterministic noise, so runs are comparable
+static short bench_noise(int amplitude)
+{
+	bench_seed = bench_seed * 1103515245 + 12345;
+	return (short)((long)((bench_seed >> 16) % (2 * amplitude + 1)) - amplitude);
+}
+
+static float bench_uniform(void)
+{
+	bench_seed = bench_seed * 1103515245 + 12345;
+	return ((bench_seed >> 8) & 0xffffff) / 16777216.0f;
+}
+
+static float bench_gauss(float sigma)
+{
+	float u1 = bench_uniform() + 1e-7f;
+	float u2 = bench_uniform();
+
+	return sigma * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+static long long cpu_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (long long)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+* @brief Fill IMU data of one FIFO read for a resting sensor
+* @param mpu pointer to IMU data
+* @return
+*
+* Level, with a constant gyro bias on all axes and some noise on every
+* sensor. The DMP quaternion is identity, as the DMP removes the bias.
+* @date 17.10.2026 born
+*
+*/
+static void bench_imu_data(mpudata_t *mpu)
+{
+	int i, j;
+
+	mpu->numPackets = BENCH_PACKETS;
+
+	for (i = 0; i < BENCH_PACKETS; i++) {
+		for (j = 0; j < 3; j++) {
+			mpu->packets[i].rawGyro[j] = BENCH_GYRO_BIAS + bench_noise(4);
+			mpu->packets[i].rawAccel[j] = bench_noise(40);
+		}
+		mpu->packets[i].rawAccel[2] += 16384;
+
+		mpu->packets[i].rawQuat[QUAT_W] = 1L << 30;
+		mpu->packets[i].rawQuat[QUAT_X] = bench_noise(1000);
+		mpu->packets[i].rawQuat[QUAT_Y] = bench_noise(1000);
+		mpu->packets[i].rawQuat[QUAT_Z] = bench_noise(1000);
+	}
+
+	memcpy(mpu->rawGyro, mpu->packets[BENCH_PACKETS - 1].rawGyro, sizeof(mpu->rawGyro));
+	memcpy(mpu->rawAccel, mpu->packets[BENCH_PACKETS - 1].rawAccel, sizeof(mpu->rawAccel));
+	memcpy(mpu->rawQuat, mpu->packets[BENCH_PACKETS - 1].rawQuat, sizeof(mpu->rawQuat));
+
+	mpu->rawMag[VEC3_X] = 120 + bench_noise(3);
+	mpu->rawMag[VEC3_Y] = 40 + bench_noise(3);
+	mpu->rawMag[VEC3_Z] = -200 + bench_noise(3);
+}
+
+/**
+* @brief CPU time per fusion update of all fusion engines
+* @param fp file pointer for output
+* @return result
+*
+* Every engine fuses the same synthetic FIFO reads. The software filters
+* must find the gyro bias the DMP removes on its own.
+* @date 17.10.2026 born
+*
+*/
+static int bench_fusion(FILE *fp)
+{
+	int engines[] = { MPU9150_FUSION_DMP, MPU9150_FUSION_MADGWICK, MPU9150_FUSION_MAHONY };
+	mpudata_t mpu;
+	long long cpu_ns;
+	long long start;
+	float bias[3];
+	unsigned long updates;
+	int result = 0;
+	int i;
+
+	fprintf(fp, "IMU fusion (%d updates at %d Hz, injected gyro bias %.3f deg/s):\n",
+		BENCH_FUSION_UPDATES, BENCH_SAMPLE_RATE, BENCH_GYRO_BIAS / 16.4f);
+
+	for (i = 0; i < (int)(sizeof(engines) / sizeof(engines[0])); i++) {
+		if (mpu9150_init_fusion(engines[i], BENCH_SAMPLE_RATE, AHRS_YAW_TIME_CONSTANT, BENCH_ROTATION) != 0) {
+			fprintf(fp, "  %-8s setup failed\n", mpu9150_fusion_name(engines[i]));
+			result = 1;
+			continue;
+		}
+
+		memset(&mpu, 0, sizeof(mpudata_t));
+		bench_seed = 1;
+		cpu_ns = 0;
+
+		for (updates = 0; updates < BENCH_FUSION_UPDATES; updates += BENCH_PACKETS) {
+			bench_imu_data(&mpu);
+
+			start = cpu_time_ns();
+			if (mpu9150_fuse(&mpu) != 0)
+				result = 1;
+			cpu_ns += cpu_time_ns() - start;
+		}
+
+		fprintf(fp, "  %-8s %7.1f ns/update  roll: %6.2f pitch: %6.2f yaw: %7.2f deg",
+			mpu9150_fusion_name(engines[i]),
+			(double)cpu_ns / updates,
+			mpu.fusedEuler[VEC3_X] * RAD_TO_DEGREE,
+			mpu.fusedEuler[VEC3_Y] * RAD_TO_DEGREE,
+			mpu.fusedEuler[VEC3_Z] * RAD_TO_DEGREE);
+
+		if (engines[i] != MPU9150_FUSION_DMP) {
+			mpu9150_get_gyro_bias(bias);
+			fprintf(fp, "  bias: %.3f %.3f %.3f deg/s", bias[0], bias[1], bias[2]);
+		}
+
+		fprintf(fp, "\n");
+	}
+
+	return result;
+}
+
+/**
+* @brief Vertical acceleration of simulated flight
+* @param t time (s)
+* @return acceleration (m/s^2)
+*
+* Climb rate steps between 0 and BENCH_VARIO_STEP every
+* BENCH_VARIO_PERIOD seconds, with a linear ramp.
+* @date 17.10.2026 born
+*
+*/
+static float bench_vario_accel(float t)
+{
+	float phase = fmodf(t, 2 * BENCH_VARIO_PERIOD);
+
+	if (phase < BENCH_VARIO_RAMP)
+		return BENCH_VARIO_STEP / BENCH_VARIO_RAMP;
+
+	if (phase >= BENCH_VARIO_PERIOD && phase < BENCH_VARIO_PERIOD + BENCH_VARIO_RAMP)
+		return -BENCH_VARIO_STEP / BENCH_VARIO_RAMP;
+
+	return 0.0f;
+}
+
+/**
+* @brief Lag and error of vario output against true climb rate
+* @param fp file pointer for output
+* @param name name of filter
+* @param out vario output at pressure sample rate
+* @param truth true climb rate at IMU rate
+* @return
+*
+* The lag is the delay of the true climb rate which fits the output best.
+* @date 17.10.2026 born
+*
+*/
+static void bench_vario_report(FILE *fp, const char *name, const float *out, const float *truth)
+{
+	int decimation = BENCH_VARIO_IMU_RATE / BENCH_VARIO_BARO_RATE;
+	int first = BENCH_VARIO_SETTLE * BENCH_VARIO_BARO_RATE;
+	int last = BENCH_VARIO_TIME * BENCH_VARIO_BARO_RATE;
+	double err, best_err = 0.0, rms = 0.0;
+	int best_lag = 0;
+	int lag, i;
+
+	for (lag = 0; lag <= BENCH_VARIO_MAX_LAG; lag++) {
+		err = 0.0;
+		for (i = first; i < last; i++)
+			err += (out[i] - truth[(i + 1) * decimation - 1 - lag]) * (out[i] - truth[(i + 1) * decimation - 1 - lag]);
+
+		if (lag == 0)
+			rms = sqrt(err / (last - first));
+
+		if (lag == 0 || err < best_err) {
+			best_err = err;
+			best_lag = lag;
+		}
+	}
+
+	fprintf(fp, "  %-14s lag: %4d ms  rms error: %.3f m/s  rms error at lag: %.3f m/s\n",
+		name,
+		best_lag * 1000 / BENCH_VARIO_IMU_RATE,
+		rms,
+		sqrt(best_err / (last - first)));
+}
+
+/**
+* @brief Latency of pressure only and baro-inertial vario
+* @param fp file pointer for output
+* @return result
+*
+* Replays a simulated flight with sensor noise into both filters. IMU
+* packets arrive in batches like the IMU reads of sensord, the vario is
+* taken at every pressure sample, as for the POV sentences.
+* @date 17.10.2026 born
+*
+*/
+static int bench_vario(FILE *fp)
+{
+	static float truth[BENCH_VARIO_TIME * BENCH_VARIO_IMU_RATE];
+	static float imu_accel[BENCH_VARIO_TIME * BENCH_VARIO_IMU_RATE];
+	static float out_1d[BENCH_VARIO_TIME * BENCH_VARIO_BARO_RATE];
+	static float out_bi[BENCH_VARIO_TIME * BENCH_VARIO_BARO_RATE];
+	int imu_per_baro = BENCH_VARIO_IMU_RATE / BENCH_VARIO_BARO_RATE;
+	int imu_per_read = BENCH_VARIO_IMU_RATE / BENCH_VARIO_IMU_READS;
+	t_kalmanfilter1d kf;
+	t_baroinertialfilter bf;
+	struct timespec t;
+	float h = 1000.0f, v = 0.0f, a;
+	float dt = 1.0f / BENCH_VARIO_IMU_RATE;
+	float p;
+	int imu_fed = 0;
+	int i, j;
+
+	bench_seed = 1;
+
+	// initialise like main, from first pressure
+	p = 1013.25f * powf(1.0f - 2.25577e-5f * h, 5.25588f);
+	KalmanFilter1d_reset(&kf);
+	kf.var_x_accel_ = 0.3f;		// as in sensord.conf
+	for (i = 0; i < 1000; i++)
+		KalmanFiler1d_update(&kf, p, 0.25, 1);
+
+	BaroInertialFilter_reset(&bf, p, 0.0f);
+	bf.var_accel_ = BARO_INERTIAL_ACCEL_VAR;
+	bf.var_bias_ = BARO_INERTIAL_BIAS_VAR;
+	bf.var_z_abs_ = BARO_INERTIAL_PRESSURE_VAR;
+
+	for (i = 0; i < BENCH_VARIO_TIME * BENCH_VARIO_IMU_RATE; i++) {
+		// true state at end of IMU period
+		a = bench_vario_accel(i * dt);
+		h += v * dt + 0.5f * a * dt * dt;
+		v += a * dt;
+		truth[i] = v;
+		imu_accel[i] = a + BENCH_ACCEL_BIAS + bench_gauss(BENCH_ACCEL_NOISE);
+
+		// IMU packets of the last read period
+		if ((i + 1) % imu_per_read == 0) {
+			for (j = imu_fed; j <= i; j++) {
+				t.tv_sec = (j + 1) / BENCH_VARIO_IMU_RATE;
+				t.tv_nsec = ((j + 1) % BENCH_VARIO_IMU_RATE) * (NSEC_PER_SEC / BENCH_VARIO_IMU_RATE);
+				BaroInertialFilter_add_accel(&bf, &t, imu_accel[j]);
+			}
+			imu_fed = i + 1;
+		}
+
+		if ((i + 1) % imu_per_baro == 0) {
+			p = 1013.25f * powf(1.0f - 2.25577e-5f * h, 5.25588f) + bench_gauss(BENCH_BARO_NOISE);
+			t.tv_sec = (i + 1) / BENCH_VARIO_IMU_RATE;
+			t.tv_nsec = ((i + 1) % BENCH_VARIO_IMU_RATE) * (NSEC_PER_SEC / BENCH_VARIO_IMU_RATE);
+
+			KalmanFiler1d_update(&kf, p, 0.25, 1.0f / BENCH_VARIO_BARO_RATE);
+			BaroInertialFilter_add_pressure(&bf, &t, p);
+
+			out_1d[i / imu_per_baro] = ComputeVario(kf.x_abs_, kf.x_vel_);
+			out_bi[i / imu_per_baro] = ComputeVario(bf.x_abs_, bf.x_vel_);
+		}
+	}
+
+	fprintf(fp, "Vario (%.1f m/s climb steps, %d Hz pressure, %d Hz IMU read in %d Hz batches):\n",
+		BENCH_VARIO_STEP, BENCH_VARIO_BARO_RATE, BENCH_VARIO_IMU_RATE, BENCH_VARIO_IMU_READS);
+	bench_vario_report(fp, "pressure only", out_1d, truth);
+	bench_vario_report(fp, "baro-inertial", out_bi, truth);
+	fprintf(fp, "  accel bias estimate: %.3f m/s^2 (injected %.3f)\n",
+		bf.x_bias_ * ComputeVario(bf.x_abs_, 1.0f), BENCH_ACCEL_BIAS);
+
+	return 0;
+}
+
+/**
+* @brief Reference formatting of the POV and RPYL sentences with sprintf
+* @param type sentence type 0..3 (P/Q, E, V, RPYL)
+* @param buf buffer for sentence
+* @param v input values
+* @return length of sentence
+*
+* Kept as the Compose_* functions were before the fixed-point encoder,
+* including the range checks.
+* @date 17.10.2026 born
+*
+*/
+static int bench_nmea_reference(int type, char *buf, const double *v)
+{
+	float f0 = v[0], f1 = v[1];
+	int length;
+
+	switch (type) {
+	case 0:
+		if ((f0 < 0) || (f0 > 2000))
+			f0 = 9999;
+		if ((f1 < -999.0) || (f1 > 9998.0))
+			f1 = 9999;
+		length = sprintf(buf, "$POV,P,%+07.2f,Q,%+05.2f", f0, f1);
+		break;
+	case 1:
+		if ((f0 < -50) || (f0 > 50))
+			f0 = 99;
+		length = sprintf(buf, "$POV,E,%+05.2f", f0);
+		break;
+	case 2:
+		if ((f0 < 2.) || (f0 > 20.))
+			f0 = 0.;
+		length = sprintf(buf, "$POV,V,%+05.2f", f0);
+		break;
+	default:
+		return snprintf(buf, NMEA_RPYL_SIZE, "$RPYL,%0.0f,%0.0f,%0.0f,0,0,%0.0f,0\r\n", v[0], v[1], v[2], v[3]);
+	}
+
+	length += sprintf(buf + length, "*%02X\n", NMEA_checksum(buf));
+	return length;
+}
+
+/**
+* @brief Format sentence with the encoder used by sensord
+* @param type sentence type 0..3 (P/Q, E, V, RPYL)
+* @param buf buffer for sentence
+* @param v input values
+* @return length of sentence
+*
+* @date 17.10.2026 born
+*
+*/
+static int bench_nmea_encode(int type, char *buf, const double *v)
+{
+	int length = 0;
+
+	switch (type) {
+	case 0:
+		Compose_Pressure_POV_slow(buf, v[0], v[1], &length);
+		break;
+	case 1:
+		Compose_Pressure_POV_fast(buf, v[0], &length);
+		break;
+	case 2:
+		Compose_Voltage_POV(buf, v[0], &length);
+		break;
+	default:
+		length = Compose_RPYL(buf, NMEA_RPYL_SIZE, v[0], v[1], v[2], v[3]);
+		break;
+	}
+
+	return length;
+}
+
+/**
+* @brief Input values for golden check
+* @param type sentence type 0..3 (P/Q, E, V, RPYL)
+* @param i number of value set
+* @param v input values
+* @return
+*
+* First some edge cases, rounding ties, out of range and non-finite
+* values, then random values over the range of each field. The POV
+* values are floats, as in sensord.
+* @date 17.10.2026 born
+*
+*/
+static void bench_nmea_values(int type, int i, double *v)
+{
+	static const double edges[] = {
+		0.0, -0.0, 0.5, -0.5, 1.5, 2.5, 0.125, 0.375, -0.125, 0.004, -0.004, 0.005, -0.005,
+		1013.245, 999.995, 99.995, 9.995, -9.995, 2000.0, 2000.01, -999.0, 9998.0, 9999.0,
+		49.995, 50.0, -50.0, 2.0, 20.0, 1.999, 1e8, -1e8, 1e12, -1e12,
+		NAN, -NAN, INFINITY, -INFINITY
+	};
+	static const double range[] = { 2100.0, 120.0, 25.0, 40000.0 };
+	int num_edges = sizeof(edges) / sizeof(edges[0]);
+	int j;
+
+	for (j = 0; j < 4; j++) {
+		if (i < num_edges * 4)
+			v[j] = edges[(i + j * 7) % num_edges];
+		else
+			v[j] = (bench_uniform() - 0.25) * range[type];
+
+		if (type < 3)
+			v[j] = (float)v[j];
+	}
+}
+
+/**
+* @brief Golden check and CPU time per sentence of the NMEA encoder
+* @param fp file pointer for output
+* @return result, 1 if an encoded sentence differs from sprintf
+*
+* @date 17.10.2026 born
+*
+*/
+static int bench_nmea(FILE *fp)
+{
+	static const char *names[] = { "POV P,Q", "POV E", "POV V", "RPYL" };
+	static double values[1024][4];
+	char expected[128], encoded[128];
+	long long start, ref_ns, enc_ns;
+	unsigned long checked = 0, mismatches = 0;
+	int type, i;
+	int result = 0;
+
+	fprintf(fp, "NMEA encoder (golden check against sprintf, %d sentences per timing run):\n", BENCH_NMEA_SENTENCES);
+
+	bench_seed = 1;
+	for (type = 0; type < 4; type++) {
+		for (i = 0; i < BENCH_NMEA_RANDOM; i++) {
+			bench_nmea_values(type, i, values[0]);
+			bench_nmea_reference(type, expected, values[0]);
+			bench_nmea_encode(type, encoded, values[0]);
+			checked++;
+
+			if (strcmp(expected, encoded) != 0) {
+				if (mismatches++ == 0)
+					fprintf(fp, "  mismatch %s: expected \"%s\" got \"%s\"\n", names[type], expected, encoded);
+				result = 1;
+			}
+		}
+	}
+	fprintf(fp, "  golden   %lu sentences, %lu mismatches\n", checked, mismatches);
+
+	for (type = 0; type < 4; type++) {
+		// typical values, no edge cases
+		for (i = 0; i < 1024; i++)
+			bench_nmea_values(type, 1000 + i, values[i]);
+
+		start = cpu_time_ns();
+		for (i = 0; i < BENCH_NMEA_SENTENCES; i++)
+			bench_nmea_reference(type, expected, values[i & 1023]);
+		ref_ns = cpu_time_ns() - start;
+
+		start = cpu_time_ns();
+		for (i = 0; i < BENCH_NMEA_SENTENCES; i++)
+			bench_nmea_encode(type, encoded, values[i & 1023]);
+		enc_ns = cpu_time_ns() - start;
+
+		fprintf(fp, "  %-8s sprintf: %6.1f ns/sentence  fixed-point: %6.1f ns/sentence  (%.1fx)\n",
+			names[type],
+			(double)ref_ns / BENCH_NMEA_SENTENCES,
+			(double)enc_ns / BENCH_NMEA_SENTENCES,
+			enc_ns > 0 ? (double)ref_ns / enc_ns : 0.0);
+	}
+
+	return result;
+}
+
+static long long mono_time_ns(void)
+{
+	struct timespec ts;
+
+	timer_now(&ts);
+	return (long long)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+* @brief Fill snapshot so that a torn read can be detected
+* @param data pointer to snapshot data
+* @param n number of update
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void bench_snapshot_fill(t_snapshot_data *data, unsigned long n)
+{
+	data->flags = SNAPSHOT_PRESSURE_VALID | SNAPSHOT_IMU_VALID;
+	data->p_static = n;
+	data->p_dynamic = n;
+	data->vkf_x_abs = n;
+	data->vkf_x_vel = n;
+	data->vario = n;
+	data->voltage = n;
+	data->fused_euler[0] = data->fused_euler[1] = data->fused_euler[2] = n;
+	data->fused_quat[0] = data->fused_quat[1] = data->fused_quat[2] = data->fused_quat[3] = n;
+	data->vert_accel = n;
+	data->imu_ts_ns = n;
+}
+
+static int bench_snapshot_torn(const t_snapshot_data *data)
+{
+	return (data->p_static != data->voltage || data->p_static != data->fused_quat[3] ||
+		data->p_static != data->vert_accel || (long long)data->p_static != data->imu_ts_ns % (1 << 24));
+}
+
+/**
+* @brief Writer thread of snapshot latency benchmark
+* @param arg pointer to writer snapshot
+* @return
+*
+* Publishes with a fixed period like the fusion thread, the time of
+* publishing goes into pressure_ts_ns.
+* @date 17.10.2026 born
+*
+*/
+static void *bench_snapshot_writer(void *arg)
+{
+	t_snapshot *writer = arg;
+	t_snapshot_data *data;
+	struct timespec next;
+	unsigned long n;
+
+	timer_now(&next);
+	for (n = 1; n <= BENCH_SNAPSHOT_UPDATES; n++) {
+		timespec_add_ns(&next, BENCH_SNAPSHOT_PERIOD);
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		data = snapshot_begin(writer);
+		bench_snapshot_fill(data, n % (1 << 24));
+		data->pressure_ts_ns = mono_time_ns();
+		snapshot_end(writer);
+	}
+
+	return NULL;
+}
+
+/**
+* @brief Cost and latency of shared memory snapshot
+* @param fp file pointer for output
+* @return result, 1 if a reader saw a torn snapshot
+*
+* The reader polls snapshot_changed like a consumer waiting for new
+* values. Latency is measured from the end of the update to the copy in
+* the reader. With both threads on one CPU it includes the wakeup of the
+* writer.
+* @date 17.10.2026 born
+*
+*/
+static int bench_snapshot(FILE *fp)
+{
+	t_snapshot writer, reader;
+	t_snapshot_data *data, copy;
+	pthread_t tid;
+	char name[32];
+	long long start, write_ns, read_ns, latency, latency_sum = 0, latency_max = 0;
+	unsigned long n, received = 0, torn = 0;
+
+	fprintf(fp, "Shared memory snapshot (%d bytes):\n", (int)sizeof(t_snapshot_data));
+
+	sprintf(name, "/sensord-bench-%d", (int)getpid());
+	if (snapshot_create(&writer, name) != 0)
+		return 1;
+	if (snapshot_attach(&reader, name) != 0) {
+		snapshot_destroy(&writer);
+		return 1;
+	}
+
+	start = cpu_time_ns();
+	for (n = 1; n <= BENCH_SNAPSHOT_LOOPS; n++) {
+		data = snapshot_begin(&writer);
+		bench_snapshot_fill(data, n % (1 << 24));
+		snapshot_end(&writer);
+	}
+	write_ns = cpu_time_ns() - start;
+
+	start = cpu_time_ns();
+	for (n = 0; n < BENCH_SNAPSHOT_LOOPS; n++) {
+		if (snapshot_read(&reader, &copy) != 0 || bench_snapshot_torn(&copy))
+			torn++;
+	}
+	read_ns = cpu_time_ns() - start;
+
+	fprintf(fp, "  update   %6.1f ns  read: %6.1f ns\n",
+		(double)write_ns / BENCH_SNAPSHOT_LOOPS,
+		(double)read_ns / BENCH_SNAPSHOT_LOOPS);
+
+	reader.reads = reader.retries = 0;
+	if (pthread_create(&tid, NULL, bench_snapshot_writer, &writer) != 0) {
+		snapshot_detach(&reader);
+		snapshot_destroy(&writer);
+		return 1;
+	}
+
+	while (received < BENCH_SNAPSHOT_UPDATES) {
+		if (!snapshot_changed(&reader))
+			continue;
+
+		if (snapshot_read(&reader, &copy) != 0 || bench_snapshot_torn(&copy)) {
+			torn++;
+			continue;
+		}
+
+		latency = mono_time_ns() - copy.pressure_ts_ns;
+		latency_sum += latency;
+		if (latency > latency_max)
+			latency_max = latency;
+
+		// updates the reader missed count as received
+		received = copy.imu_ts_ns;
+	}
+	pthread_join(tid, NULL);
+
+	fprintf(fp, "  latency  reads: %lu avg: %.2f us max: %.2f us retries: %lu torn: %lu\n",
+		reader.reads,
+		reader.reads ? (double)latency_sum / reader.reads / 1000 : 0.0,
+		(double)latency_max / 1000,
+		reader.retries,
+		torn);
+
+	snapshot_detach(&reader);
+	snapshot_destroy(&writer);
+
+	return (torn > 0);
+}
+
+/**
+* @brief Write pressure record with payload derived from its number
+* @param ring pointer to producer ring
+* @param n number of record
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void bench_ring_write(t_sample_ring *ring, uint32_t n)
+{
+	t_sample_record *rec = sample_ring_reserve(ring, SAMPLE_RECORD_PRESSURE);
+
+	rec->ts_ns = n;
+	rec->pressure.static_d1 = n;
+	rec->pressure.tep_d1 = ~n;
+	rec->pressure.p_static = n & 0xFFFF;
+	sample_ring_commit(ring);
+}
+
+static int bench_ring_check(const t_sample_record *rec)
+{
+	return (rec->type != SAMPLE_RECORD_PRESSURE || rec->ts_ns != rec->seq ||
+		rec->pressure.static_d1 != rec->seq || rec->pressure.tep_d1 != ~rec->seq ||
+		rec->pressure.p_static != (rec->seq & 0xFFFF));
+}
+
+/**
+* @brief Cost per record and overrun detection of shared memory sample ring
+* @param fp file pointer for output
+* @return result, 1 if records were corrupt or lost records were miscounted
+*
+* A reader which is more than one lap behind must skip exactly the
+* overwritten records and continue with the oldest one still in the ring.
+* @date 17.10.2026 born
+*
+*/
+static int bench_sample_ring(FILE *fp)
+{
+	t_sample_ring producer, reader;
+	t_sample_record rec;
+	char name[32];
+	long long start, write_ns = 0, read_ns = 0;
+	unsigned long n, read = 0, bad = 0;
+	uint32_t expected;
+	int i;
+
+	fprintf(fp, "Shared memory sample ring (%d byte records, %d slots):\n", (int)sizeof(t_sample_record), BENCH_RING_SLOTS);
+
+	sprintf(name, "/sensord-bench-%d", (int)getpid());
+	if (sample_ring_create(&producer, name, BENCH_RING_SLOTS) != 0)
+		return 1;
+	if (sample_ring_attach(&reader, name) != 0) {
+		sample_ring_destroy(&producer);
+		return 1;
+	}
+
+	for (n = 0; n < BENCH_RING_RECORDS; n += BENCH_RING_BATCH) {
+		start = cpu_time_ns();
+		for (i = 0; i < BENCH_RING_BATCH; i++)
+			bench_ring_write(&producer, n + i);
+		write_ns += cpu_time_ns() - start;
+
+		start = cpu_time_ns();
+		while (sample_ring_read(&reader, &rec) == 0) {
+			read++;
+			bad += bench_ring_check(&rec);
+		}
+		read_ns += cpu_time_ns() - start;
+	}
+
+	fprintf(fp, "  write    %6.1f ns/record (%.1f M records/s)  read: %6.1f ns/record  lost: %lu corrupt: %lu\n",
+		(double)write_ns / n,
+		write_ns > 0 ? (double)n * 1000 / write_ns : 0.0,
+		read > 0 ? (double)read_ns / read : 0.0,
+		reader.lost,
+		bad);
+
+	// slow reader, 3 laps behind
+	reader.lost = reader.overruns = 0;
+	for (i = 0; i < 3 * BENCH_RING_SLOTS; i++)
+		bench_ring_write(&producer, n + i);
+
+	read = 0;
+	expected = n + 2 * BENCH_RING_SLOTS;
+	while (sample_ring_read(&reader, &rec) == 0) {
+		if (bench_ring_check(&rec) || rec.seq != expected)
+			bad++;
+		expected++;
+		read++;
+	}
+
+	fprintf(fp, "  overrun  behind: %d read: %lu lost: %lu overruns: %lu corrupt: %lu\n",
+		3 * BENCH_RING_SLOTS,
+		read,
+		reader.lost,
+		reader.overruns,
+		bad);
+
+	sample_ring_detach(&reader);
+	sample_ring_destroy(&producer);
+
+	return (bad > 0 || read != BENCH_RING_SLOTS || reader.lost != 2 * BENCH_RING_SLOTS);
+}
+
+/**
+* @brief Connected pair of loopback TCP sockets
+* @param fd sockets, [0] for sending, [1] for receiving
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+static int bench_tcp_pair(int fd[2])
+{
+	struct sockaddr_in addr;
+	socklen_t len = sizeof(addr);
+	int lfd, one = 1;
+
+	lfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (lfd < 0)
+		return 1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	fd[0] = fd[1] = -1;
+	if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+		listen(lfd, 1) == 0 &&
+		getsockname(lfd, (struct sockaddr *)&addr, &len) == 0 &&
+		(fd[0] = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) >= 0 &&
+		connect(fd[0], (struct sockaddr *)&addr, sizeof(addr)) == 0)
+		fd[1] = accept(lfd, NULL, NULL);
+	close(lfd);
+
+	if (fd[1] < 0) {
+		if (fd[0] >= 0)
+			close(fd[0]);
+		return 1;
+	}
+
+	// no Nagle delay, the reader waits for every batch
+	setsockopt(fd[0], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	return (0);
+}
+
+/**
+* @brief Send output ticks through connected sockets and receive them
+* @param fd sockets, [0] for sending, [1] for receiving
+* @param msg one output tick
+* @param len length of tick
+* @param seqpacket 1 if every tick must arrive as one message
+* @param bad counter for lost or split messages
+* @return time in ns
+*
+* @date 17.10.2026 born
+*
+*/
+static long long bench_socket_run(int fd[2], const char *msg, size_t len, int seqpacket, unsigned long *bad)
+{
+	char buf[4096];
+	long long start = mono_time_ns();
+	size_t got;
+	ssize_t r;
+	int n, i;
+
+	for (n = 0; n < BENCH_SOCKET_MESSAGES; n += BENCH_SOCKET_BATCH) {
+		for (i = 0; i < BENCH_SOCKET_BATCH; i++) {
+			if (send(fd[0], msg, len, MSG_NOSIGNAL) != (ssize_t)len)
+				(*bad)++;
+		}
+
+		for (got = 0; got < BENCH_SOCKET_BATCH * len; got += r) {
+			r = recv(fd[1], buf, sizeof(buf), 0);
+			if (r <= 0) {
+				(*bad)++;
+				break;
+			}
+			if (seqpacket && (size_t)r != len)
+				(*bad)++;
+		}
+	}
+
+	return mono_time_ns() - start;
+}
+
+/**
+* @brief Cost per output tick of loopback TCP and Unix domain socket
+* @param fp file pointer for output
+* @return result, 1 if a message was lost or split
+*
+* Sender and receiver run in one thread, so the time is the CPU cost of
+* both sides in the kernel without scheduling.
+* @date 17.10.2026 born
+*
+*/
+static int bench_local_sockets(FILE *fp)
+{
+	char msg[256];
+	int fd[2];
+	int len, n;
+	unsigned long bad = 0;
+	long long tcp_ns, uds_ns;
+
+	Compose_Pressure_POV_slow(msg, 101325.0, 0.52, &len);
+	Compose_Pressure_POV_fast(msg + len, 1.23, &n);
+	len += n;
+	Compose_Voltage_POV(msg + len, 12.6, &n);
+	len += n;
+
+	fprintf(fp, "Local output (%d byte ticks, %d ticks):\n", len, BENCH_SOCKET_MESSAGES);
+
+	if (bench_tcp_pair(fd) != 0) {
+		fprintf(fp, "  tcp      loopback not available\n");
+		return 1;
+	}
+	tcp_ns = bench_socket_run(fd, msg, len, 0, &bad);
+	close(fd[0]);
+	close(fd[1]);
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fd) != 0) {
+		fprintf(fp, "  uds      SOCK_SEQPACKET not available\n");
+		return 1;
+	}
+	uds_ns = bench_socket_run(fd, msg, len, 1, &bad);
+	close(fd[0]);
+	close(fd[1]);
+
+	fprintf(fp, "  tcp      %6.2f us/tick\n", (double)tcp_ns / BENCH_SOCKET_MESSAGES / 1000);
+	fprintf(fp, "  uds      %6.2f us/tick  (%.1fx)  lost or split: %lu\n",
+		(double)uds_ns / BENCH_SOCKET_MESSAGES / 1000,
+		uds_ns > 0 ? (double)tcp_ns / uds_ns : 0.0,
+		bad);
+
+	return (bad > 0);
+}
+
+/**
+* @brief Check edge event counting of a fake GPIO line
+* @param fp file pointer for output
+* @return result, 1 if events were lost, counted twice or misaligned
+*
+* A FIFO delivers records in the pieces they were written. An incomplete
+* record must be completed by the next read, not dropped.
+* @date 17.10.2026 born
+*
+*/
+static int bench_gpio(FILE *fp)
+{
+	struct gpioevent_data events[BENCH_GPIO_EVENTS];
+	t_gpio_line line;
+	char path[64];
+	const char *p;
+	size_t left, n;
+	int fd, i, whole, split = 0;
+
+	fprintf(fp, "Fake GPIO line (%d byte records):\n", (int)sizeof(struct gpioevent_data));
+
+	memset(events, 0, sizeof(events));
+	for (i = 0; i < BENCH_GPIO_EVENTS; i++) {
+		events[i].timestamp = i;
+		events[i].id = GPIOEVENT_EVENT_FALLING_EDGE;
+	}
+
+	sprintf(path, "/tmp/sensord-bench-gpio-%d", (int)getpid());
+	unlink(path);
+	if (mkfifo(path, 0600) != 0) {
+		fprintf(fp, "  fifo     not available\n");
+		return 1;
+	}
+	if (gpio_line_open(&line, path, 0, 1) != 0) {
+		unlink(path);
+		return 1;
+	}
+	fd = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+	unlink(path);
+	if (fd < 0) {
+		gpio_line_close(&line);
+		return 1;
+	}
+
+	// all records with one write
+	if (write(fd, events, sizeof(events)) != sizeof(events))
+		whole = -1;
+	else
+		whole = gpio_line_read_events(&line);
+
+	// same records in pieces, read after every piece
+	p = (const char *)events;
+	left = sizeof(events);
+	while (left > 0) {
+		n = left < BENCH_GPIO_SPLIT ? left : BENCH_GPIO_SPLIT;
+		if (write(fd, p, n) != (ssize_t)n)
+			break;
+		p += n;
+		left -= n;
+		split += gpio_line_read_events(&line);
+	}
+
+	fprintf(fp, "  whole    written: %d read: %d\n", BENCH_GPIO_EVENTS, whole);
+	fprintf(fp, "  split    written: %d in %d byte pieces read: %d errors: %lu\n",
+		BENCH_GPIO_EVENTS, BENCH_GPIO_SPLIT, split, line.errors);
+
+	close(fd);
+	gpio_line_close(&line);
+
+	return (whole != BENCH_GPIO_EVENTS || split != BENCH_GPIO_EVENTS ||
+		line.partial_len != 0 || line.errors != 0);
+}
+
+/**
+* @brief Run built-in benchmarks
+* @param fp file pointer for output
+* @return result
+*
+* Runs without sensors, on synthetic data.
+* @date 17.10.2026 born
+*
+*/
+int benchmark_run(FILE *fp)
+{
+	int result = 0;
+
+	fprintf(fp, "sensord benchmark\n\n");
+
+	result |= bench_fusion(fp);
+	fprintf(fp, "\n");
+	result |= bench_vario(fp);
+	fprintf(fp, "\n");
+	result |= bench_nmea(fp);
+	fprintf(fp, "\n");
+	result |= bench_snapshot(fp);
+	fprintf(fp, "\n");
+	result |= bench_sample_ring(fp);
+	fprintf(fp, "\n");
+	result |= bench_local_sockets(fp);
+	fprintf(fp, "\n");
+	result |= bench_gpio(fp);
+
+	return result;
+}
@@ -53,10 +53,11 @@ void cmdline_parser(int argc, char **argv, t_io_mode *io_mode){
 	"  -r [filename]   record measurement values to file\n"\
 	"  -s              second order temperature compensation for MS5611 enable"
 	"  -p [filename]   use values from file instead of measuring\n"\
+	"  -b              run benchmarks on synthetic data and exit\n"\
 	"\n";
 	
 	// check commandline arguments
-	while ((c = getopt (argc, argv, "vd::flhr:p:c:s")) != -1)
+	while ((c = getopt (argc, argv, "vd::flhr:p:c:sb")) != -1)
 	{
 		switch (c) {
 			case 'v':
@@ -156,6 +157,11 @@ void cmdline_parser(int argc, char **argv, t_io_mode *io_mode){
 				}
 				break;
 				
+			case 'b':
+				// run benchmarks instead of measuring
+				io_mode->benchmark = TRUE;
+				break;
+				
 			case '?':
 				printf("Unknow option %c\n", optopt);
 				printf("Usage: sensord [OPTION]\n%s",Usage);
@@ -30,37 +30,48 @@
 
 #include "configfile_parser.h"
 
-
+// longest config line, two socket paths of 107 characters fit
+#define CFG_LINE_SIZE	256
 
 extern int g_debug;
 extern FILE *fp_console;
 
 int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_ams5915 *dynamic_sensor, t_ads1110 *voltage_sensor, t_mpu9150 *mpu_sensor, t_config *config)
 {
-	char line[70];
-	char tmp[20];
+	char line[CFG_LINE_SIZE];
+	char tmp[32];
+	char fusion[20];
+	int c;
 		
 	// is config file used ??
 	if (fp)
 	{
 		// read whole config file
-		while (! feof(fp))
+		while (fgets(line, sizeof(line), fp) != NULL)
 		{
-			// get line from config file
-			fgets(line, 70, fp);
 			//printf("getting line: '%s'\n", line);
 			
+			// a line without newline is cut, unless it is the last one
+			if (strchr(line, '\n') == NULL && !feof(fp))
+			{
+				fprintf(stderr, "Config line too long, ignored: %.40s...\n", line);
+				while ((c = fgetc(fp)) != EOF && c != '\n')
+					;
+				continue;
+			}
+			
 			// check if line is comment
 			if((!(line[0] == '#')) && (!(line[0] == '\n')))
 			{
 			
 				// get first config tag
-				sscanf(line, "%s", tmp);
+				sscanf(line, "%31s", tmp);
 				
 				// check for output of POV_E sentence
 				if (strcmp(tmp,"output_POV_E") == 0)
 				{	
 					config->output_POV_E = 1;
+					sscanf(line, "%31s %d", tmp, &config->output_POV_E_rate);
 					//printf("OUTput POV_E enabled !! \n");
 				}
 				
@@ -68,6 +79,7 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 				if (strcmp(tmp,"output_POV_P_Q") == 0)
 				{	
 					config->output_POV_P_Q = 1;
+					sscanf(line, "%31s %d", tmp, &config->output_POV_P_Q_rate);
 					//printf("OUTput POV_P_Q enabled !! \n");
 				}
 				
@@ -75,6 +87,7 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 				if (strcmp(tmp,"output_POV_V") == 0)
 				{	
 					config->output_POV_V= 1;
+					sscanf(line, "%31s %d", tmp, &config->output_POV_V_rate);
 					//printf("OUTput POV_P_Q enabled !! \n");
 				}
 				
@@ -82,64 +95,183 @@ int cfgfile_parser(FILE *fp, t_ms5611 *static_sensor, t_ms5611 *tek_sensor, t_am
 				if (strcmp(tmp,"static_sensor") == 0)
 				{
 					// get config data for static sensor
-					sscanf(line, "%s %f %f", tmp, &static_sensor->offset, &static_sensor->linearity);
+					sscanf(line, "%31s %f %f %d", tmp, &static_sensor->offset, &static_sensor->linearity, &static_sensor->osr);
 				}
 				
 				// check for tek_sensor
 				if (strcmp(tmp,"tek_sensor") == 0)
 				{
 					// get config data for tek sensor
-					sscanf(line, "%s %f %f", tmp, &tek_sensor->offset, &tek_sensor->linearity);	
+					sscanf(line, "%31s %f %f %d", tmp, &tek_sensor->offset, &tek_sensor->linearity, &tek_sensor->osr);
 				}
 				
 				// check for dynamic_sensor
 				if (strcmp(tmp,"dynamic_sensor") == 0)
 				{
 					// get config data for dynamic sensor
-					sscanf(line, "%s %f %f", tmp, &dynamic_sensor->offset, &dynamic_sensor->linearity);
+					sscanf(line, "%31s %f %f", tmp, &dynamic_sensor->offset, &dynamic_sensor->linearity);
 				}
 				
 				// check for vario config
 				if (strcmp(tmp,"vario_config") == 0)
 				{
 					// get config data for dynamic sensor
-					sscanf(line, "%s %f", tmp, &config->vario_x_accel);
+					sscanf(line, "%31s %f", tmp, &config->vario_x_accel);
+				}
+				
+				// check for baro-inertial vario config
+				if (strcmp(tmp,"vario_imu_config") == 0)
+				{
+					// get config data for baro-inertial vario
+					sscanf(line, "%31s %d %f %f", tmp, &config->vario_imu, &config->vario_accel_var, &config->vario_baro_var);
 				}
 				
 				// check for voltage sensor config
 				if (strcmp(tmp,"voltage_config") == 0)
 				{
 					// get config data for dynamic sensor
-					sscanf(line, "%s %f", tmp, &voltage_sensor->voltage_factor);
+					sscanf(line, "%31s %f", tmp, &voltage_sensor->voltage_factor);
 				}
 
 				// check for mpu orientation config
 				if (strcmp(tmp,"mpu_rotation") == 0)
 				{
 					// get config data for mpu orientation
-					sscanf(line, "%s %d", tmp, &mpu_sensor->rotation);
+					sscanf(line, "%31s %d", tmp, &mpu_sensor->rotation);
 				}
 
 				// check for mpu roll adjustment
 				if (strcmp(tmp,"roll_adjust") == 0)
 				{
 					// get config data for mpu roll adjustment
-					sscanf(line, "%s %f", tmp, &mpu_sensor->roll_adjust);
+					sscanf(line, "%31s %f", tmp, &mpu_sensor->roll_adjust);
 				}
 
 				// check for mpu pitch adjustment
 				if (strcmp(tmp,"pitch_adjust") == 0)
 				{
 					// get config data for mpu pitch adjustment
-					sscanf(line, "%s %f", tmp, &mpu_sensor->pitch_adjust);
+					sscanf(line, "%31s %f", tmp, &mpu_sensor->pitch_adjust);
 				}
 
 				// check for mpu yaw adjustment
 				if (strcmp(tmp,"yaw_adjust") == 0)
 				{
 					// get config data for mpu yaw adjustment
-					sscanf(line, "%s %f", tmp, &mpu_sensor->yaw_adjust);
-				}				
+					sscanf(line, "%31s %f", tmp, &mpu_sensor->yaw_adjust);
+				}
+
+				// check for mpu FIFO read mode
+				if (strcmp(tmp,"mpu_fifo_burst") == 0)
+				{
+					// get config data for mpu FIFO read mode
+					sscanf(line, "%31s %d", tmp, &mpu_sensor->fifo_burst);
+				}
+
+				// check for mpu fusion engine
+				if (strcmp(tmp,"mpu_fusion") == 0)
+				{
+					// get config data for mpu fusion engine
+					sscanf(line, "%31s %19s", tmp, fusion);
+					if (strcmp(fusion, "dmp") == 0)
+						mpu_sensor->fusion = MPU9150_FUSION_DMP;
+					else if (strcmp(fusion, "madgwick") == 0)
+						mpu_sensor->fusion = MPU9150_FUSION_MADGWICK;
+					else if (strcmp(fusion, "mahony") == 0)
+						mpu_sensor->fusion = MPU9150_FUSION_MAHONY;
+					else
+						printf("Unknown mpu_fusion %s, using %s\n", fusion, mpu9150_fusion_name(mpu_sensor->fusion));
+				}
+
+				// check for mpu sample rate
+				if (strcmp(tmp,"mpu_sample_rate") == 0)
+				{
+					// get config data for mpu sample rate
+					sscanf(line, "%31s %d", tmp, &mpu_sensor->sample_rate);
+				}
+
+				// check for ahrs output rate
+				if (strcmp(tmp,"ahrs_output_rate") == 0)
+				{
+					// get config data for ahrs output rate
+					sscanf(line, "%31s %d", tmp, &mpu_sensor->output_rate);
+				}
+
+				// check for yaw mix time constant
+				if (strcmp(tmp,"mpu_yaw_time_constant") == 0)
+				{
+					// get config data for yaw mix time constant
+					sscanf(line, "%31s %f", tmp, &mpu_sensor->yaw_time_constant);
+				}
+
+				// check for mpu data ready interrupt line
+				if (strcmp(tmp,"mpu_int_gpio") == 0)
+				{
+					// get config data for mpu interrupt line
+					sscanf(line, "%31s %63s %d %d", tmp, mpu_sensor->int_gpio_chip, &mpu_sensor->int_gpio_line, &mpu_sensor->int_active_low);
+				}
+				
+				// check for measurement schedule
+				if (strcmp(tmp,"schedule_tick_rate") == 0)
+				{
+					sscanf(line, "%31s %d", tmp, &config->tick_rate);
+				}
+				
+				if (strcmp(tmp,"pressure_rate") == 0)
+				{
+					sscanf(line, "%31s %d", tmp, &config->pressure_rate);
+				}
+				
+				if (strcmp(tmp,"temp_refresh") == 0)
+				{
+					sscanf(line, "%31s %d %d %f", tmp, &config->temp_min_interval, &config->temp_max_interval, &config->temp_max_error);
+				}
+				
+				if (strcmp(tmp,"i2c_clock") == 0)
+				{
+					sscanf(line, "%31s %d", tmp, &config->i2c_clock);
+				}
+				
+				// check for server mode
+				if (strcmp(tmp,"output_server") == 0)
+				{
+					sscanf(line, "%31s %d %15s", tmp, &config->output_server, config->server_address);
+				}
+				
+				// check for UDP output
+				if (strcmp(tmp,"udp_output") == 0)
+				{
+					sscanf(line, "%31s %d %15s %d %d %d %15s", tmp, &config->udp_enable, config->udp_address, &config->udp_ov_port, &config->udp_ahrs_port, &config->udp_ttl, config->udp_interface);
+				}
+				
+				// check for Unix domain socket output
+				if (strcmp(tmp,"uds_output") == 0)
+				{
+					sscanf(line, "%31s %d %107s %107s %d", tmp, &config->uds_enable, config->uds_ov_path, config->uds_ahrs_path, &config->uds_allow_uid);
+				}
+				
+				// check for shared memory snapshot
+				if (strcmp(tmp,"shm_snapshot") == 0)
+				{
+					sscanf(line, "%31s %d %31s", tmp, &config->snapshot_enable, config->snapshot_name);
+				}
+				
+				// check for shared memory sample ring
+				if (strcmp(tmp,"shm_samples") == 0)
+				{
+					sscanf(line, "%31s %d %31s %u", tmp, &config->samples_enable, config->samples_name, &config->samples_slots);
+				}
+				
+				// check for real-time settings
+				if (strcmp(tmp,"realtime") == 0)
+				{
+					sscanf(line, "%31s %d %d", tmp, &config->rt_enable, &config->rt_priority);
+				}
+				
+				if (strcmp(tmp,"cpu_affinity") == 0)
+				{
+					sscanf(line, "%31s %d %d %d %d", tmp, &config->cpu_acquisition, &config->cpu_i2c, &config->cpu_fusion, &config->cpu_output);
+				}
 			}
 	
 			
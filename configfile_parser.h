@@ -21,7 +21,42 @@ typedef struct {
 	char output_POV_E;
 	char output_POV_P_Q;
 	char output_POV_V;
+	int output_POV_E_rate;
+	int output_POV_P_Q_rate;
+	int output_POV_V_rate;
+	int tick_rate;
+	int pressure_rate;
+	int temp_min_interval;
+	int temp_max_interval;
+	float temp_max_error;
+	int i2c_clock;
+	int rt_enable;
+	int rt_priority;
+	int cpu_acquisition;
+	int cpu_i2c;
+	int cpu_fusion;
+	int cpu_output;
+	int output_server;
+	char server_address[16];
+	int udp_enable;
+	char udp_address[16];
+	int udp_ov_port;
+	int udp_ahrs_port;
+	int udp_ttl;
+	char udp_interface[16];
+	int uds_enable;
+	char uds_ov_path[108];
+	char uds_ahrs_path[108];
+	int uds_allow_uid;
+	int snapshot_enable;
+	char snapshot_name[32];
+	int samples_enable;
+	char samples_name[32];
+	unsigned int samples_slots;
 	float vario_x_accel;
+	int vario_imu;
+	float vario_accel_var;
+	float vario_baro_var;
 	int mpu_rotation;
 	float roll_adjust;
 	float pitch_adjust;
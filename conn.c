@@ -0,0 +1,475 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "conn.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include "timer.h"
+#include "def.h"
+
+extern int g_debug;
+extern FILE *fp_console;
+
+/**
+* @brief Initialize connection, first attempt is made by conn_poll
+* @param conn pointer to connection instance
+* @param name name of connection for messages and statistics
+* @param ip IPv4 address of server
+* @param port TCP port of server
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void conn_init(t_conn *conn, const char *name, const char *ip, int port)
+{
+	memset(conn, 0, sizeof(t_conn));
+	conn->name = name;
+	conn->fd = -1;
+	conn->state = CONN_IDLE;
+	conn->outgoing = 1;
+	conn->backoff_ns = CONN_BACKOFF_MIN_NS;
+
+	conn->addr.sin_family = AF_INET;
+	conn->addr.sin_addr.s_addr = inet_addr(ip);
+	conn->addr.sin_port = htons(port);
+}
+
+/**
+* @brief Use accepted connection
+* @param conn pointer to connection instance
+* @param name name of connection for messages and statistics
+* @param fd connected socket, non-blocking
+* @return
+*
+* The connection is not remade after it was lost, conn_connected tells
+* when it can be reused.
+* @date 17.10.2026 born
+*
+*/
+void conn_attach(t_conn *conn, const char *name, int fd)
+{
+	int sndbuf = CONN_SNDBUF;
+
+	memset(conn, 0, sizeof(t_conn));
+	conn->name = name;
+	conn->fd = fd;
+	conn->state = CONN_CONNECTED;
+	conn->connects = 1;
+	conn->backoff_ns = CONN_BACKOFF_MIN_NS;
+
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+}
+
+/**
+* @brief Close socket and schedule next attempt after backoff
+* @param conn pointer to connection instance
+* @param now current time
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void conn_retry(t_conn *conn, const struct timespec *now)
+{
+	close(conn->fd);
+	conn->fd = -1;
+	conn->state = CONN_IDLE;
+
+	conn->next_attempt = *now;
+	timespec_add_ns(&conn->next_attempt, conn->backoff_ns);
+
+	conn->backoff_ns *= 2;
+	if (conn->backoff_ns > CONN_BACKOFF_MAX_NS)
+		conn->backoff_ns = CONN_BACKOFF_MAX_NS;
+}
+
+/**
+* @brief Give up connect attempt
+* @param conn pointer to connection instance
+* @param now current time
+* @param error errno of failed attempt
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void conn_fail(t_conn *conn, const struct timespec *now, int error)
+{
+	debug_print("failed to connect (%s): %s, next attempt in %lldms\n", conn->name, strerror(error), conn->backoff_ns / 1000000);
+
+	conn_retry(conn, now);
+}
+
+/**
+* @brief Mark connection as established
+* @param conn pointer to connection instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void conn_established(t_conn *conn)
+{
+	conn->state = CONN_CONNECTED;
+	conn->backoff_ns = CONN_BACKOFF_MIN_NS;
+	conn->pending_len = 0;
+	conn->connects++;
+
+	debug_print("connected (%s)\n", conn->name);
+}
+
+/**
+* @brief Start non-blocking connect
+* @param conn pointer to connection instance
+* @param now current time
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void conn_start(t_conn *conn, const struct timespec *now)
+{
+	int sndbuf = CONN_SNDBUF;
+
+	conn->attempts++;
+
+	conn->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (conn->fd < 0)
+	{
+		conn_fail(conn, now, errno);
+		return;
+	}
+
+	// keep only little data queued in the kernel, so a slow receiver gets recent values
+	setsockopt(conn->fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+	if (connect(conn->fd, (struct sockaddr *)&conn->addr, sizeof(conn->addr)) == 0)
+	{
+		conn_established(conn);
+		return;
+	}
+
+	if (errno != EINPROGRESS)
+	{
+		conn_fail(conn, now, errno);
+		return;
+	}
+
+	// remember start of attempt for timeout
+	conn->state = CONN_CONNECTING;
+	conn->next_attempt = *now;
+}
+
+/**
+* @brief Check result of non-blocking connect
+* @param conn pointer to connection instance
+* @param now current time
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void conn_check(t_conn *conn, const struct timespec *now)
+{
+	struct pollfd pfd;
+	int error = 0;
+	socklen_t len = sizeof(error);
+
+	pfd.fd = conn->fd;
+	pfd.events = POLLOUT;
+	pfd.revents = 0;
+
+	if (poll(&pfd, 1, 0) == 0)
+	{
+		// still in progress
+		if (timespec_diff_ns(now, &conn->next_attempt) > CONN_TIMEOUT_NS)
+			conn_fail(conn, now, ETIMEDOUT);
+		return;
+	}
+
+	if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
+		error = errno;
+
+	if (error != 0)
+		conn_fail(conn, now, error);
+	else
+		conn_established(conn);
+}
+
+/**
+* @brief Drop connection after send error, next attempt after min. backoff
+* @param conn pointer to connection instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void conn_lost(t_conn *conn)
+{
+	struct timespec now;
+
+	fprintf(stderr, "connection lost (%s): %s\n", conn->name, strerror(errno));
+
+	conn->drops++;
+	conn->backoff_ns = CONN_BACKOFF_MIN_NS;
+	timer_now(&now);
+	conn_retry(conn, &now);
+}
+
+/**
+* @brief Write output buffer and new data with one non-blocking sendmsg
+* @param conn pointer to connection instance
+* @param buf new data, NULL to flush output buffer only
+* @param len number of bytes of new data
+* @return result
+*
+* What the socket does not take is appended to the output buffer. The
+* caller makes sure it fits. Any progress on the output buffer restarts
+* the stall timer.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+static int conn_write(t_conn *conn, const char *buf, size_t len)
+{
+	struct iovec iov[2];
+	struct msghdr msg;
+	ssize_t n;
+	size_t pending_len = conn->pending_len;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+
+	if (pending_len > 0)
+	{
+		iov[msg.msg_iovlen].iov_base = conn->pending;
+		iov[msg.msg_iovlen].iov_len = pending_len;
+		msg.msg_iovlen++;
+	}
+
+	if (len > 0)
+	{
+		iov[msg.msg_iovlen].iov_base = (void *)buf;
+		iov[msg.msg_iovlen].iov_len = len;
+		msg.msg_iovlen++;
+	}
+
+	conn->writes++;
+	n = sendmsg(conn->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+	if (n < 0)
+	{
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+		{
+			conn_lost(conn);
+			return 1;
+		}
+		n = 0;
+	}
+
+	conn->bytes += n;
+
+	// receiver still reads, even if slower than we write
+	if (pending_len > 0 && n > 0)
+		timer_now(&conn->pending_since);
+
+	// remove sent part of output buffer
+	if ((size_t)n < pending_len)
+	{
+		memmove(conn->pending, conn->pending + n, pending_len - n);
+		conn->pending_len = pending_len - n;
+		n = 0;
+	}
+	else
+	{
+		conn->pending_len = 0;
+		n -= pending_len;
+	}
+
+	// keep rest of new data
+	if ((size_t)n < len)
+	{
+		if (conn->pending_len == 0)
+			timer_now(&conn->pending_since);
+
+		memcpy(conn->pending + conn->pending_len, buf + n, len - n);
+		conn->pending_len += len - n;
+	}
+
+	return (0);
+}
+
+/**
+* @brief Send data without blocking
+* @param conn pointer to connection instance
+* @param buf data, one or more complete NMEA sentences
+* @param len number of bytes
+* @return 0 if sent, buffered or dropped, 1 if not connected
+*
+* Buffered data is sent first, together with the new data in one
+* sendmsg, so the stream never contains partial sentences. If the new
+* data does not fit into the output buffer the receiver is too slow and
+* it is dropped, as newer values follow. Latency is bounded by the small
+* socket send buffer and by dropping the connection when no byte of the
+* output buffer was sent for CONN_STALL_NS.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int conn_send(t_conn *conn, const char *buf, size_t len)
+{
+	if (conn->state != CONN_CONNECTED)
+		return 1;
+
+	if (len > CONN_PENDING_SIZE - conn->pending_len)
+	{
+		conn->overflows++;
+		len = 0;
+	}
+
+	if (len == 0 && conn->pending_len == 0)
+		return (0);
+
+	return (conn_write(conn, buf, len));
+}
+
+/**
+* @brief Flush output buffer, drop stalled connection
+* @param conn pointer to connection instance
+* @param now current time
+* @return
+*
+* A connection is stalled when the socket took nothing from the output
+* buffer for CONN_STALL_NS. A receiver which keeps reading slowly keeps
+* its connection, its sends are dropped while the buffer is full.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+static void conn_drain(t_conn *conn, const struct timespec *now)
+{
+	if (conn->pending_len == 0)
+		return;
+
+	if (timespec_diff_ns(now, &conn->pending_since) > CONN_STALL_NS)
+	{
+		errno = ETIMEDOUT;
+		conn_lost(conn);
+		return;
+	}
+
+	conn_write(conn, NULL, 0);
+}
+
+/**
+* @brief Drive connection state machine
+* @param conn pointer to connection instance
+* @return
+*
+* Never blocks. Called periodically by the output thread, the connection
+* joins the running stream as soon as it is established. Data left in the
+* output buffer is sent.
+* @date 17.10.2026 born
+*
+*/
+void conn_poll(t_conn *conn)
+{
+	struct timespec now;
+
+	timer_now(&now);
+
+	switch (conn->state)
+	{
+		case CONN_IDLE:
+			if (conn->outgoing && timespec_diff_ns(&now, &conn->next_attempt) >= 0)
+				conn_start(conn, &now);
+			break;
+
+		case CONN_CONNECTING:
+			conn_check(conn, &now);
+			break;
+
+		case CONN_CONNECTED:
+			conn_drain(conn, &now);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+* @brief Check if connection is established
+* @param conn pointer to connection instance
+* @return 1 if connected
+*
+* @date 17.10.2026 born
+*
+*/
+int conn_connected(t_conn *conn)
+{
+	return (conn->state == CONN_CONNECTED);
+}
+
+/**
+* @brief Close connection
+* @param conn pointer to connection instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void conn_close(t_conn *conn)
+{
+	if (conn->fd >= 0)
+		close(conn->fd);
+
+	conn->fd = -1;
+	conn->state = CONN_IDLE;
+}
+
+/**
+* @brief Print connection statistics
+* @param conn pointer to connection instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void conn_print_stats(t_conn *conn, FILE *fp)
+{
+	static const char *states[] = { "idle", "connecting", "connected" };
+
+	fprintf(fp, "  %-8s %s attempts: %lu connects: %lu drops: %lu overflows: %lu writes: %lu sent: %llukB\n",
+		conn->name,
+		states[conn->state],
+		conn->attempts,
+		conn->connects,
+		conn->drops,
+		conn->overflows,
+		conn->writes,
+		conn->bytes / 1024);
+}
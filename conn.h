@@ -0,0 +1,73 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CONN_H
+#define CONN_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+#include <netinet/in.h>
+
+#define CONN_BACKOFF_MIN_NS		250000000LL		// first retry after failed connect (ns)
+#define CONN_BACKOFF_MAX_NS		8000000000LL	// max. time between connect attempts (ns)
+#define CONN_TIMEOUT_NS			2000000000LL	// connect attempt is given up after (ns)
+#define CONN_PENDING_SIZE		1024			// output buffer for data the socket did not take
+#define CONN_SNDBUF				4096			// socket send buffer, bounds data queued in the kernel
+#define CONN_STALL_NS			1000000000LL	// connection is dropped if nothing of output buffer is sent for (ns)
+
+// connection states
+enum {
+	CONN_IDLE,						// not connected, waiting for next attempt
+	CONN_CONNECTING,				// non-blocking connect in progress
+	CONN_CONNECTED
+};
+
+// define struct for TCP connection, managed by the output thread
+typedef struct {
+	const char *name;
+	struct sockaddr_in addr;
+	int fd;
+	int state;
+	int outgoing;					// 1 if connected by us and reconnected after loss
+	long long backoff_ns;
+	struct timespec next_attempt;	// or start of running attempt
+	char pending[CONN_PENDING_SIZE];
+	size_t pending_len;
+	struct timespec pending_since;	// time output buffer was filled or last sent from
+
+	// statistics
+	unsigned long attempts;
+	unsigned long connects;
+	unsigned long drops;			// connections lost
+	unsigned long overflows;		// sends dropped, output buffer full
+	unsigned long writes;			// sendmsg calls
+	unsigned long long bytes;
+} t_conn;
+
+// prototypes
+void conn_init(t_conn *, const char *, const char *, int);
+void conn_attach(t_conn *, const char *, int);
+void conn_poll(t_conn *);
+int conn_connected(t_conn *);
+int conn_send(t_conn *, const char *, size_t);
+void conn_close(t_conn *);
+void conn_print_stats(t_conn *, FILE *);
+
+#endif
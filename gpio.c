@@ -0,0 +1,168 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gpio.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/gpio.h>
+#include "def.h"
+
+extern int g_debug;
+extern FILE *fp_console;
+
+/**
+* @brief Request edge events of GPIO line
+* @param line pointer to line instance
+* @param chip path of GPIO character device, e.g. /dev/gpiochip0
+* @param offset number of line at this chip
+* @param falling_edge 1 for falling edge (active low), 0 for rising edge
+* @return result
+*
+* If chip is a named pipe instead of a GPIO character device, its fd is
+* used as line fd directly. Writing struct gpioevent_data records into the
+* pipe then fakes edges, so interrupt mode can run without hardware.
+* @date 17.10.2026 born
+*
+*/
+int gpio_line_open(t_gpio_line *line, const char *chip, int offset, int falling_edge)
+{
+	struct gpioevent_request req;
+	struct stat st;
+	int fd;
+
+	memset(line, 0, sizeof(t_gpio_line));
+	line->fd = -1;
+
+	if (stat(chip, &st) == 0 && S_ISFIFO(st.st_mode))
+	{
+		// O_RDWR keeps the pipe open if the writer goes away
+		line->fd = open(chip, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+		if (line->fd < 0)
+		{
+			fprintf(stderr, "Error opening %s: %s\n", chip, strerror(errno));
+			return 1;
+		}
+		line->fake = 1;
+		if (g_debug > 0) printf("Using %s as fake GPIO line\n", chip);
+		return (0);
+	}
+
+	fd = open(chip, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		fprintf(stderr, "Error opening %s: %s\n", chip, strerror(errno));
+		return 1;
+	}
+
+	memset(&req, 0, sizeof(req));
+	req.lineoffset = offset;
+	req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+	req.eventflags = falling_edge ? GPIOEVENT_REQUEST_FALLING_EDGE : GPIOEVENT_REQUEST_RISING_EDGE;
+	strncpy(req.consumer_label, "sensord", sizeof(req.consumer_label) - 1);
+
+	if (ioctl(fd, GPIO_GET_LINEEVENT_IOCTL, &req) < 0)
+	{
+		fprintf(stderr, "Error requesting %s line %d: %s\n", chip, offset, strerror(errno));
+		close(fd);
+		return 1;
+	}
+	close(fd);
+
+	line->fd = req.fd;
+	fcntl(line->fd, F_SETFL, fcntl(line->fd, F_GETFL) | O_NONBLOCK);
+	fcntl(line->fd, F_SETFD, FD_CLOEXEC);
+
+	if (g_debug > 0) printf("Opened GPIO %s line %d\n", chip, offset);
+
+	return (0);
+}
+
+/**
+* @brief Read all pending edge events
+* @param line pointer to line instance
+* @return number of events, 0 if none pending
+*
+* The GPIO device always delivers whole records, a FIFO may not. The bytes
+* of an incomplete record are kept until the rest arrives, so the stream
+* stays aligned.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int gpio_line_read_events(t_gpio_line *line)
+{
+	ssize_t len;
+	int count = 0;
+
+	while ((len = read(line->fd, (char *)&line->partial + line->partial_len, sizeof(line->partial) - line->partial_len)) > 0)
+	{
+		line->partial_len += len;
+		if (line->partial_len == sizeof(line->partial))
+		{
+			line->partial_len = 0;
+			count++;
+		}
+	}
+
+	if (len < 0 && errno != EAGAIN && errno != EINTR)
+		line->errors++;
+
+	line->events += count;
+	return count;
+}
+
+/**
+* @brief Release GPIO line
+* @param line pointer to line instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void gpio_line_close(t_gpio_line *line)
+{
+	if (line->fd >= 0)
+		close(line->fd);
+
+	line->fd = -1;
+}
+
+/**
+* @brief Print line statistics
+* @param line pointer to line instance
+* @param name name of line for output
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void gpio_line_print_stats(t_gpio_line *line, const char *name, FILE *fp)
+{
+	fprintf(fp, "  %-8s %sevents: %lu errors: %lu\n",
+		name,
+		line->fake ? "(fake) " : "",
+		line->events,
+		line->errors);
+}
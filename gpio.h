@@ -0,0 +1,43 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <linux/gpio.h>
+
+// define struct for GPIO line delivering edge events
+typedef struct {
+	int fd;
+	int fake;					// fd is a FIFO delivering gpioevent_data records
+	struct gpioevent_data partial;	// record read in pieces, only from a FIFO
+	size_t partial_len;
+	unsigned long events;
+	unsigned long errors;
+} t_gpio_line;
+
+// prototypes
+int gpio_line_open(t_gpio_line *, const char *, int, int);
+int gpio_line_read_events(t_gpio_line *);
+void gpio_line_close(t_gpio_line *);
+void gpio_line_print_stats(t_gpio_line *, const char *, FILE *);
+
+#endif
@@ -0,0 +1,309 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "i2c_bus.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "timer.h"
+#include "def.h"
+
+extern int g_debug;
+extern FILE *fp_console;
+
+/**
+* @brief Open I2C bus
+* @param bus pointer to bus instance
+* @param bus_nr number of bus, e.g. 1 for /dev/i2c-1
+* @return result
+*
+* All devices on the bus share this file descriptor. The slave address is
+* part of every message, so there is no I2C_SLAVE ioctl per device.
+* @date 17.10.2026 born
+*
+*/
+int i2c_bus_open(t_i2c_bus *bus, int bus_nr)
+{
+	char name[32];
+
+	memset(bus, 0, sizeof(t_i2c_bus));
+	bus->bus_nr = bus_nr;
+
+	sprintf(name, "/dev/i2c-%d", bus_nr);
+	bus->fd = open(name, O_RDWR | O_CLOEXEC);
+
+	if (bus->fd < 0) {
+		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
+		return 1;
+	}
+
+	if (g_debug > 0) printf("Opened I2C bus %s\n", name);
+
+	return (0);
+}
+
+/**
+* @brief Close I2C bus
+* @param bus pointer to bus instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void i2c_bus_close(t_i2c_bus *bus)
+{
+	if (bus->fd >= 0)
+		close(bus->fd);
+
+	bus->fd = -1;
+}
+
+/**
+* @brief Run combined I2C transfer
+* @param bus pointer to bus instance
+* @param msgs array of I2C messages
+* @param nmsgs number of messages
+* @return result
+*
+* All messages are sent with one I2C_RDWR ioctl, separated by repeated
+* starts.
+* @date 17.10.2026 born
+*
+*/
+int i2c_bus_transfer(t_i2c_bus *bus, struct i2c_msg *msgs, int nmsgs)
+{
+	struct i2c_rdwr_ioctl_data rdwr;
+	struct timespec start, end;
+	long long duration;
+	int result;
+
+	if (bus == NULL || bus->fd < 0)
+		return 1;
+
+	rdwr.msgs = msgs;
+	rdwr.nmsgs = nmsgs;
+
+	timer_now(&start);
+	result = ioctl(bus->fd, I2C_RDWR, &rdwr);
+	timer_now(&end);
+
+	duration = timespec_diff_ns(&end, &start);
+	bus->busy_ns += duration;
+	if (duration > bus->busy_max_ns)
+		bus->busy_max_ns = duration;
+
+	bus->transfers++;
+	bus->messages += nmsgs;
+
+	if (result != nmsgs)
+	{
+		bus->errors++;
+		ddebug_print("I2C transfer to 0x%x failed: %s\n", msgs[0].addr, strerror(errno));
+		return 1;
+	}
+
+	return (0);
+}
+
+/**
+* @brief Write to I2C device
+* @param bus pointer to bus instance
+* @param address I2C address of device
+* @param buf data to write
+* @param len number of bytes
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int i2c_bus_write(t_i2c_bus *bus, unsigned char address, const unsigned char *buf, unsigned short len)
+{
+	struct i2c_msg msg;
+
+	msg.addr = address;
+	msg.flags = 0;
+	msg.len = len;
+	msg.buf = (unsigned char *)buf;
+
+	return (i2c_bus_transfer(bus, &msg, 1));
+}
+
+/**
+* @brief Read from I2C device
+* @param bus pointer to bus instance
+* @param address I2C address of device
+* @param buf buffer for data
+* @param len number of bytes
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int i2c_bus_read(t_i2c_bus *bus, unsigned char address, unsigned char *buf, unsigned short len)
+{
+	struct i2c_msg msg;
+
+	msg.addr = address;
+	msg.flags = I2C_M_RD;
+	msg.len = len;
+	msg.buf = buf;
+
+	return (i2c_bus_transfer(bus, &msg, 1));
+}
+
+/**
+* @brief Write to and read back from I2C device in one transfer
+* @param bus pointer to bus instance
+* @param address I2C address of device
+* @param wbuf data to write (usually register address or command)
+* @param wlen number of bytes to write
+* @param rbuf buffer for data read back
+* @param rlen number of bytes to read
+* @return result
+*
+* Write and read are joined by a repeated start, so a register read
+* costs one syscall instead of a write() and a read().
+* @date 17.10.2026 born
+*
+*/
+int i2c_bus_write_read(t_i2c_bus *bus, unsigned char address, const unsigned char *wbuf, unsigned short wlen, unsigned char *rbuf, unsigned short rlen)
+{
+	struct i2c_msg msgs[2];
+
+	msgs[0].addr = address;
+	msgs[0].flags = 0;
+	msgs[0].len = wlen;
+	msgs[0].buf = (unsigned char *)wbuf;
+
+	msgs[1].addr = address;
+	msgs[1].flags = I2C_M_RD;
+	msgs[1].len = rlen;
+	msgs[1].buf = rbuf;
+
+	return (i2c_bus_transfer(bus, msgs, 2));
+}
+
+/**
+* @brief Print bus statistics
+* @param bus pointer to bus instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void i2c_bus_print_stats(t_i2c_bus *bus, FILE *fp)
+{
+	fprintf(fp, "  i2c-%d    transfers: %lu messages: %lu errors: %lu busy: %lldms max transfer: %lldus\n",
+		bus->bus_nr,
+		bus->transfers,
+		bus->messages,
+		bus->errors,
+		bus->busy_ns / 1000000,
+		bus->busy_max_ns / 1000);
+}
+
+/**
+* @brief Initialize empty batch
+* @param batch pointer to batch instance
+* @return
+*
+* A batch collects messages for several devices, which are then sent
+* with one I2C_RDWR ioctl by i2c_batch_run. The data buffers must stay
+* valid until the batch was run.
+* @date 17.10.2026 born
+*
+*/
+void i2c_batch_init(t_i2c_batch *batch)
+{
+	batch->nmsgs = 0;
+}
+
+/**
+* @brief Add write message to batch
+* @param batch pointer to batch instance
+* @param address I2C address of device
+* @param buf data to write
+* @param len number of bytes
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int i2c_batch_add_write(t_i2c_batch *batch, unsigned char address, const unsigned char *buf, unsigned short len)
+{
+	if (batch->nmsgs >= I2C_BATCH_MAX_MSGS)
+		return 1;
+
+	batch->msgs[batch->nmsgs].addr = address;
+	batch->msgs[batch->nmsgs].flags = 0;
+	batch->msgs[batch->nmsgs].len = len;
+	batch->msgs[batch->nmsgs].buf = (unsigned char *)buf;
+	batch->nmsgs++;
+
+	return (0);
+}
+
+/**
+* @brief Add read message to batch
+* @param batch pointer to batch instance
+* @param address I2C address of device
+* @param buf buffer for data
+* @param len number of bytes
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int i2c_batch_add_read(t_i2c_batch *batch, unsigned char address, unsigned char *buf, unsigned short len)
+{
+	if (batch->nmsgs >= I2C_BATCH_MAX_MSGS)
+		return 1;
+
+	batch->msgs[batch->nmsgs].addr = address;
+	batch->msgs[batch->nmsgs].flags = I2C_M_RD;
+	batch->msgs[batch->nmsgs].len = len;
+	batch->msgs[batch->nmsgs].buf = buf;
+	batch->nmsgs++;
+
+	return (0);
+}
+
+/**
+* @brief Send all messages of batch in one transfer
+* @param bus pointer to bus instance
+* @param batch pointer to batch instance
+* @return result
+*
+* If one device does not acknowledge, the whole transfer fails.
+* @date 17.10.2026 born
+*
+*/
+int i2c_batch_run(t_i2c_bus *bus, t_i2c_batch *batch)
+{
+	if (batch->nmsgs == 0)
+		return (0);
+
+	return (i2c_bus_transfer(bus, batch->msgs, batch->nmsgs));
+}
@@ -0,0 +1,61 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdio.h>
+#include <linux/i2c.h>
+
+#define I2C_BATCH_MAX_MSGS	16
+
+// define struct for I2C bus shared by all sensor drivers
+typedef struct {
+	int fd;
+	int bus_nr;
+
+	// statistics
+	unsigned long transfers;		// I2C_RDWR ioctls
+	unsigned long messages;			// I2C messages in these transfers
+	unsigned long errors;
+	long long busy_ns;				// time spent in I2C_RDWR
+	long long busy_max_ns;			// longest single transfer
+} t_i2c_bus;
+
+// define struct for messages to several devices sent in one transfer
+typedef struct {
+	struct i2c_msg msgs[I2C_BATCH_MAX_MSGS];
+	int nmsgs;
+} t_i2c_batch;
+
+// prototypes
+int i2c_bus_open(t_i2c_bus *, int);
+void i2c_bus_close(t_i2c_bus *);
+int i2c_bus_transfer(t_i2c_bus *, struct i2c_msg *, int);
+int i2c_bus_write(t_i2c_bus *, unsigned char, const unsigned char *, unsigned short);
+int i2c_bus_read(t_i2c_bus *, unsigned char, unsigned char *, unsigned short);
+int i2c_bus_write_read(t_i2c_bus *, unsigned char, const unsigned char *, unsigned short, unsigned char *, unsigned short);
+void i2c_bus_print_stats(t_i2c_bus *, FILE *);
+
+void i2c_batch_init(t_i2c_batch *);
+int i2c_batch_add_write(t_i2c_batch *, unsigned char, const unsigned char *, unsigned short);
+int i2c_batch_add_read(t_i2c_batch *, unsigned char, unsigned char *, unsigned short);
+int i2c_batch_run(t_i2c_bus *, t_i2c_batch *);
+
+#endif
@@ -0,0 +1,350 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "i2c_queue.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "timer.h"
+
+/**
+* @brief Initialize transaction queue
+* @param queue pointer to queue instance
+* @return result
+*
+* All bus access after i2c_queue_start has to go through the queue, as the
+* worker thread then owns the bus.
+* @date 17.10.2026 born
+*
+*/
+int i2c_queue_init(t_i2c_queue *queue)
+{
+	pthread_condattr_t attr;
+	int result;
+
+	memset(queue, 0, sizeof(t_i2c_queue));
+
+	// release times of delayed transactions are CLOCK_MONOTONIC
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	result = pthread_cond_init(&queue->cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	if ((pthread_mutex_init(&queue->lock, NULL) != 0) || (result != 0))
+	{
+		fprintf(stderr, "I2C queue init failed\n");
+		return 1;
+	}
+
+	return (0);
+}
+
+/**
+* @brief Register device for statistics
+* @param queue pointer to queue instance
+* @param device pointer to device instance
+* @param name name of device for statistics
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int i2c_queue_add_device(t_i2c_queue *queue, t_i2c_device *device, const char *name)
+{
+	if (queue->num_devices >= I2C_QUEUE_MAX_DEVICES)
+	{
+		fprintf(stderr, "Too many I2C queue devices (%s)\n", name);
+		return 1;
+	}
+
+	memset(device, 0, sizeof(t_i2c_device));
+	device->name = name;
+	queue->devices[queue->num_devices++] = device;
+
+	return (0);
+}
+
+/**
+* @brief Take next transaction from queue
+* @param queue pointer to queue instance, must be locked
+* @param job pointer to buffer for transaction
+* @param now current time
+* @param release earliest release time, if no transaction is due yet
+* @return 0 if transaction was taken, 1 if none is due
+*
+* Of the due transactions lowest priority value first, then earliest
+* deadline, then earliest submit.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+static int i2c_queue_take(t_i2c_queue *queue, t_i2c_job *job, const struct timespec *now, struct timespec *release)
+{
+	int i, best = -1, next = -1;
+	long long diff;
+
+	for (i = 0; i < queue->num_jobs; i++)
+	{
+		if (timespec_diff_ns(&queue->jobs[i].submitted, now) > 0)
+		{
+			// delayed transaction, not due yet
+			if (next < 0 || timespec_diff_ns(&queue->jobs[i].submitted, &queue->jobs[next].submitted) < 0)
+				next = i;
+			continue;
+		}
+
+		if (best < 0)
+		{
+			best = i;
+			continue;
+		}
+
+		if (queue->jobs[i].priority != queue->jobs[best].priority)
+		{
+			if (queue->jobs[i].priority < queue->jobs[best].priority)
+				best = i;
+			continue;
+		}
+
+		diff = timespec_diff_ns(&queue->jobs[i].deadline, &queue->jobs[best].deadline);
+		if ((diff < 0) || ((diff == 0) && (timespec_diff_ns(&queue->jobs[i].submitted, &queue->jobs[best].submitted) < 0)))
+			best = i;
+	}
+
+	if (best < 0)
+	{
+		*release = queue->jobs[next].submitted;
+		return 1;
+	}
+
+	*job = queue->jobs[best];
+	queue->jobs[best] = queue->jobs[--queue->num_jobs];
+	return (0);
+}
+
+/**
+* @brief Worker thread running the queued transactions
+* @param arg pointer to queue instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void *i2c_queue_worker(void *arg)
+{
+	t_i2c_queue *queue = arg;
+	t_i2c_job job;
+	struct timespec start, end, release;
+	long long latency;
+	int result;
+
+	pthread_mutex_lock(&queue->lock);
+	while (queue->running)
+	{
+		if (queue->num_jobs == 0)
+		{
+			pthread_cond_wait(&queue->cond, &queue->lock);
+			continue;
+		}
+
+		timer_now(&start);
+		if (i2c_queue_take(queue, &job, &start, &release) != 0)
+		{
+			// sleep until the first delayed transaction is due or a new one comes in
+			pthread_cond_timedwait(&queue->cond, &queue->lock, &release);
+			continue;
+		}
+		pthread_mutex_unlock(&queue->lock);
+
+		timer_now(&start);
+		result = job.run(job.arg);
+		timer_now(&end);
+
+		// update statistics of device
+		latency = timespec_diff_ns(&start, &job.submitted);
+		job.device->jobs++;
+		job.device->latency_sum_ns += latency;
+		if (latency > job.device->latency_max_ns)
+			job.device->latency_max_ns = latency;
+		if (result != 0)
+			job.device->errors++;
+		if (timespec_diff_ns(&end, &job.deadline) > 0)
+			job.device->misses++;
+
+		if (job.done != NULL)
+			job.done(job.arg, result, &end);
+
+		pthread_mutex_lock(&queue->lock);
+	}
+	pthread_mutex_unlock(&queue->lock);
+
+	return NULL;
+}
+
+/**
+* @brief Start worker thread
+* @param queue pointer to queue instance
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int i2c_queue_start(t_i2c_queue *queue)
+{
+	queue->running = 1;
+
+	if (pthread_create(&queue->tid, NULL, i2c_queue_worker, queue) != 0)
+	{
+		fprintf(stderr, "Can't create I2C worker thread\n");
+		queue->running = 0;
+		return 1;
+	}
+
+	return (0);
+}
+
+/**
+* @brief Stop worker thread
+* @param queue pointer to queue instance
+* @return
+*
+* The transaction currently on the bus is finished, queued ones are dropped.
+* @date 17.10.2026 born
+*
+*/
+void i2c_queue_stop(t_i2c_queue *queue)
+{
+	if (!queue->running)
+		return;
+
+	pthread_mutex_lock(&queue->lock);
+	queue->running = 0;
+	queue->num_jobs = 0;
+	pthread_cond_signal(&queue->cond);
+	pthread_mutex_unlock(&queue->lock);
+
+	pthread_join(queue->tid, NULL);
+}
+
+/**
+* @brief Queue transaction
+* @param queue pointer to queue instance
+* @param device device for statistics
+* @param priority I2C_PRIO_TRIGGER, I2C_PRIO_READ or I2C_PRIO_BULK
+* @param deadline_ns time until transaction must be finished
+* @param run function doing the bus access
+* @param done completion callback, may be NULL
+* @param arg argument for run and done
+* @return 0 if queued, 1 if queue was full
+*
+* The completion callback gets the CLOCK_MONOTONIC time at which run
+* returned, i.e. when the last I2C transfer was finished. Sensor samples
+* are stamped with it.
+* @date 17.10.2026 born
+*
+*/
+int i2c_queue_submit(t_i2c_queue *queue, t_i2c_device *device, int priority, long long deadline_ns, t_i2c_job_func run, t_i2c_done_func done, void *arg)
+{
+	return (i2c_queue_submit_at(queue, device, priority, NULL, deadline_ns, run, done, arg));
+}
+
+/**
+* @brief Queue transaction which must not start before given time
+* @param queue pointer to queue instance
+* @param device device for statistics
+* @param priority I2C_PRIO_TRIGGER, I2C_PRIO_READ or I2C_PRIO_BULK
+* @param release absolute CLOCK_MONOTONIC time, NULL for now
+* @param deadline_ns time after release until transaction must be finished
+* @param run function doing the bus access
+* @param done completion callback, may be NULL
+* @param arg argument for run and done
+* @return 0 if queued, 1 if queue was full
+*
+* Used to read a conversion result as soon as the conversion is complete.
+* The latency statistics count from the release time.
+* @date 17.10.2026 born
+*
+*/
+int i2c_queue_submit_at(t_i2c_queue *queue, t_i2c_device *device, int priority, const struct timespec *release, long long deadline_ns, t_i2c_job_func run, t_i2c_done_func done, void *arg)
+{
+	t_i2c_job *job;
+
+	pthread_mutex_lock(&queue->lock);
+
+	if (queue->num_jobs >= I2C_QUEUE_SIZE)
+	{
+		device->rejects++;
+		pthread_mutex_unlock(&queue->lock);
+		return 1;
+	}
+
+	job = &queue->jobs[queue->num_jobs++];
+	job->device = device;
+	job->priority = priority;
+	if (release != NULL)
+		job->submitted = *release;
+	else
+		timer_now(&job->submitted);
+	job->deadline = job->submitted;
+	timespec_add_ns(&job->deadline, deadline_ns);
+	job->run = run;
+	job->done = done;
+	job->arg = arg;
+
+	if (queue->num_jobs > queue->max_depth)
+		queue->max_depth = queue->num_jobs;
+
+	pthread_cond_signal(&queue->cond);
+	pthread_mutex_unlock(&queue->lock);
+
+	return (0);
+}
+
+/**
+* @brief Print queue statistics
+* @param queue pointer to queue instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void i2c_queue_print_stats(t_i2c_queue *queue, FILE *fp)
+{
+	int i;
+	t_i2c_device *device;
+
+	fprintf(fp, "  queue    size: %d max depth: %d\n", I2C_QUEUE_SIZE, queue->max_depth);
+
+	for (i = 0; i < queue->num_devices; i++)
+	{
+		device = queue->devices[i];
+		if (device->jobs == 0)
+			continue;
+
+		fprintf(fp, "  %-8s jobs: %lu errors: %lu deadline misses: %lu rejects: %lu latency avg: %lldus max: %lldus\n",
+			device->name,
+			device->jobs,
+			device->errors,
+			device->misses,
+			device->rejects,
+			device->latency_sum_ns / device->jobs / 1000,
+			device->latency_max_ns / 1000);
+	}
+}
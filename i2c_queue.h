@@ -0,0 +1,84 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef I2C_QUEUE_H
+#define I2C_QUEUE_H
+
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#define I2C_QUEUE_SIZE			32
+#define I2C_QUEUE_MAX_DEVICES	8
+
+// priorities of transactions, lower value runs first
+enum {
+	I2C_PRIO_TRIGGER,			// conversion starts, sampling instant depends on them
+	I2C_PRIO_READ,				// reads of finished conversions
+	I2C_PRIO_BULK				// FIFO bursts
+};
+
+typedef int (*t_i2c_job_func)(void *);
+typedef void (*t_i2c_done_func)(void *, int, const struct timespec *);
+
+// statistics of one device (or group of devices) using the queue
+typedef struct {
+	const char *name;
+	unsigned long jobs;				// transactions run
+	unsigned long errors;			// transactions which returned an error
+	unsigned long misses;			// transactions finished after deadline
+	unsigned long rejects;			// transactions not queued, queue full
+	long long latency_sum_ns;		// sum of start - submit
+	long long latency_max_ns;
+} t_i2c_device;
+
+// define struct for one queued transaction
+typedef struct {
+	t_i2c_device *device;
+	int priority;
+	struct timespec submitted;		// or release time of delayed transaction
+	struct timespec deadline;		// absolute, CLOCK_MONOTONIC
+	t_i2c_job_func run;				// does the bus access, runs in worker thread
+	t_i2c_done_func done;			// completion callback with result and end of run, runs in worker thread
+	void *arg;
+} t_i2c_job;
+
+// define struct for transaction queue and its worker thread
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t tid;
+	int running;
+	int num_jobs;
+	int max_depth;
+	t_i2c_job jobs[I2C_QUEUE_SIZE];
+	int num_devices;
+	t_i2c_device *devices[I2C_QUEUE_MAX_DEVICES];
+} t_i2c_queue;
+
+// prototypes
+int i2c_queue_init(t_i2c_queue *);
+int i2c_queue_add_device(t_i2c_queue *, t_i2c_device *, const char *);
+int i2c_queue_start(t_i2c_queue *);
+void i2c_queue_stop(t_i2c_queue *);
+int i2c_queue_submit(t_i2c_queue *, t_i2c_device *, int, long long, t_i2c_job_func, t_i2c_done_func, void *);
+int i2c_queue_submit_at(t_i2c_queue *, t_i2c_device *, int, const struct timespec *, long long, t_i2c_job_func, t_i2c_done_func, void *);
+void i2c_queue_print_stats(t_i2c_queue *, FILE *);
+
+#endif
@@ -31,13 +31,17 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/signalfd.h>
 #include <arpa/inet.h>
 #include <syslog.h>
+#include <pthread.h>
+#include <stdint.h>
 //#include "version.h"
 #include "nmea.h"
 //#include "w1.h"
 #include "def.h"
 #include "KalmanFilter1d.h"
+#include "BaroInertialFilter.h"
 
 #include "cmdline_parser.h"
 
@@ -54,25 +58,66 @@
 #include "ahrs_settings.h"
 
 #include "configfile_parser.h"
+#include "reactor.h"
+#include "timer.h"
+#include "ringbuf.h"
+#include "sample.h"
+#include "i2c_bus.h"
+#include "i2c_queue.h"
+#include "gpio.h"
+#include "benchmark.h"
+#include "schedule.h"
+#include "rt.h"
+#include "overload.h"
+#include "conn.h"
+#include "server.h"
+#include "udp_sink.h"
+#include "uds_server.h"
+#include "snapshot.h"
+#include "sample_ring.h"
 
 #define I2C_ADDR 0x76
-#define PRESSURE_SAMPLE_RATE 	20	// sample rate of pressure values (Hz)
-#define TEMP_SAMPLE_RATE 		5	// sample rate of temp values (Hz)
+#define PRESSURE_SAMPLE_RATE 	20	// default sample rate of pressure values (Hz)
+#define TEMP_MIN_INTERVAL_MS	200		// default min. interval of temperature refresh (ms)
+#define TEMP_MAX_INTERVAL_MS	5000	// default max. interval of temperature refresh (ms)
+#define TEMP_MAX_ERROR			1.0		// default tolerated pressure error of stale temperature (Pa)
+#define TEMP_DRIFT_WINDOW_NS	2000000000LL	// min. time between readings for drift estimate (ns)
 #define NMEA_SLOW_SEND_RATE		2	// NMEA send rate for SLOW Data (pressures, etc..) (Hz)
-#define MPU_SAMPLE_RATE			20  // sample rate of MPU9150
-#define YAW_MIX_FACTOR			4   // Yaw mix factor for fused mag/accel values
+#define MPU_SAMPLE_RATE			20  // default sample rate of MPU9150
 #define I2C_BUS					1
+#define TICK_RATE				80	// default rate of main loop tick for pressure measurement (Hz)
+#define NMEA_SEND_RATE			16	// default NMEA send rate for POV sentences (Hz)
+#define STATS_INTERVAL			10	// interval of runtime statistics in debug mode (s)
+#define RING_SIZE				64	// number of samples in pipeline ring buffers
+#define TRIGGER_DEADLINE_NS		2000000	// max delay of conversion start (ns)
+#define READ_DEADLINE_NS		2000000	// max delay of read after end of conversion (ns)
+#define IMU_WATCHDOG_PERIODS	2	// IMU read without interrupt after this many sample periods
+#define VARIO_IMU_TIMEOUT_NS	500000000	// vario falls back to pressure only filter after IMU gap (ns)
+#define PRESSURE_SMOOTH_TAU		0.174	// time constant of static and dynamic pressure smoothing (s)
+#define PRESSURE_MAX_DT			0.5		// limit of measured pressure sample interval (s)
+#define RT_PRIORITY				50		// default SCHED_FIFO priority of acquisition in real-time mode
+#define OVERLOAD_WINDOW_NS		1000000000LL	// window of deadline miss check for load shedding (ns)
+#define OVERLOAD_MISS_THRESHOLD	3		// deadline misses per window which raise the shedding level
+#define OVERLOAD_AHRS_FACTOR	4		// AHRS output rate is divided by this factor under overload
+#define OVERLOAD_VOLTAGE_DIVIDER	10	// voltage is read every n-th pressure cycle under overload
  
 #define MEASTIMER (SIGRTMAX)
 #define DELTA_TIME_US(T1, T2)	(((T1.tv_sec+1.0e-9*T1.tv_nsec)-(T2.tv_sec+1.0e-9*T2.tv_nsec))*1000000)	
 
 #define OV_PORT 				4353  // Port for OpenVario output
 #define AHRS_PORT				2000  // Port for LevilAHRD output
+#define AHRS_MESSAGE_SIZE		NMEA_RPYL_SIZE	// max. length of one $RPYL sentence
+#define AHRS_BATCH_SIZE			(8*AHRS_MESSAGE_SIZE)	// attitude sentences sent with one write
+#define NMEA_TICK_SIZE			256		// buffer for all POV sentences of one output tick
+#define CONN_POLL_NS			100000000	// interval of connection state check in output thread (ns)
 					
 timer_t  measTimer;
 int g_debug=0;
 int g_log=0;
 
+// I2C bus shared by all sensors
+t_i2c_bus sensor_bus;
+
 // Sensor objects
 t_ms5611 static_sensor;
 t_ms5611 tep_sensor;
@@ -85,11 +130,110 @@ t_config config;
 
 // Filter objects
 t_kalmanfilter1d vkf;
+t_baroinertialfilter vbf;
+int vbf_active = 0;		// IMU data drives the vario
+unsigned long vbf_fallbacks = 0;
+
+// IMU data
+mpudata_t mpu;
+mpudata_t mpu_fused;
+
+// pipeline from acquisition over fusion to output thread
+t_spsc_ring pressure_ring;
+t_spsc_ring imu_ring;
+t_spsc_ring vario_ring;
+t_spsc_ring ahrs_ring;
+pthread_t fusion_tid;
+pthread_t output_tid;
+
+// event loop objects
+t_reactor reactor;
+t_reactor fusion_reactor;
+t_reactor output_reactor;
+t_reactor_event tick_event;
+t_reactor_event imu_event;
+t_reactor_event imu_int_event;
+t_reactor_event stats_event;
+t_reactor_event overload_event;
+t_reactor_event signal_event;
+t_reactor_event pressure_ring_event;
+t_reactor_event imu_ring_event;
+t_reactor_event vario_ring_event;
+t_reactor_event ahrs_ring_event;
+t_reactor_event nmea_event;
+t_reactor_event conn_event;
+t_reactor_event ov_accept_event;
+t_reactor_event ahrs_accept_event;
+t_reactor_event ov_uds_accept_event;
+t_reactor_event ahrs_uds_accept_event;
+int signal_fd;
+
+// latest filtered values for output
+t_vario_sample vario_state;
+
+// tick tables of measurement and output
+t_schedule schedule;
+
+// temperature refresh
+t_temp_refresh temp_refresh;
+
+// real-time settings applied at startup
+t_rt rt;
+
+// load shedding after deadline misses
+t_overload overload;
+
+// bus time spent per pressure measurement tick and IMU update
+t_tick_bus_stats pressure_bus_stats;
+t_tick_bus_stats imu_bus_stats;
+
+// sample age at output
+t_age_stats vario_age_stats;
+t_age_stats ahrs_age_stats;
+
+// I2C transactions after startup, run by worker thread
+t_i2c_queue i2c_queue;
+t_i2c_device pressure_device;
+t_i2c_device imu_device;
+int imu_job_pending = 0;
+
+// data ready interrupt of IMU
+t_gpio_line mpu_int_line;
+int imu_int_mode = 0;
+unsigned long imu_watchdog_reads = 0;
+
+// IMU rates
+int imu_poll_rate = AHRS_SAMPLE_RATE_HZ;
+int ahrs_decimation = 1;
+int ahrs_decimation_count = 0;
+
+// connections to XCSoar and LevilAHRS driver
+t_conn xcsoar_conn;
+t_conn ahrs_conn;
+
+// listening sockets in server mode
+t_server ov_server;
+t_server ahrs_server;
+
+// UDP output, in addition to TCP
+t_udp_sink ov_udp;
+t_udp_sink ahrs_udp;
+
+// Unix domain socket output for local consumers, in addition to TCP
+t_uds_server ov_uds;
+t_uds_server ahrs_uds;
+
+// latest fused values in shared memory
+t_snapshot snapshot;
+
+// all raw samples in shared memory
+t_sample_ring sample_ring;
 	
 // pressures
 float tep;
 float p_static;
 float p_dynamic;
+char tep_valid;
 
 int g_foreground=TRUE;
 int g_secordcomp=FALSE;
@@ -108,19 +252,59 @@ enum e_state { IDLE, TEMP, PRESSURE} state = IDLE;
 //typedef enum { measure_only, record, replay} t_measurement_mode;
 
 /**
-* @brief Signal handler if sensord will be interrupted
-* @param sig_num
+* @brief Stop worker threads
 * @return 
 * 
-* Signal handler for catching STRG-C singal from command line
-* Closes all open files handles like log files
-* @date 17.04.2014 born
+* Called on the main thread after the acquisition loop returned. The I2C
+* worker is stopped first, as its completions feed fusion, then fusion and
+* output. The output thread closes all connections and sockets on its way
+* out.
+* @date 17.10.2026 born
 *
 */ 
-void sigintHandler(int sig_num){
+void stop_threads(void)
+{
+	i2c_queue_stop(&i2c_queue);
+	
+	reactor_stop(&fusion_reactor);
+	pthread_join(fusion_tid, NULL);
+	
+	reactor_stop(&output_reactor);
+	pthread_join(output_tid, NULL);
+}
 
-	signal(SIGINT, sigintHandler);
+/**
+* @brief Remove shared memory and socket files
+* @return 
+* 
+* Objects which were not created or are already removed are skipped, so
+* this is safe on every exit path, also if setup failed half way.
+* @date 17.10.2026 born
+*
+*/ 
+void remove_shared_objects(void)
+{
+	// remove shared memory, readers notice the stopped timestamps
+	snapshot_destroy(&snapshot);
+	sample_ring_destroy(&sample_ring);
 	
+	// remove socket files, if the output thread did not do it already
+	uds_server_close(&ov_uds);
+	uds_server_close(&ahrs_uds);
+}
+
+/**
+* @brief Release resources before sensord exits
+* @return 
+* 
+* Closes all open files handles like log files and removes the shared
+* memory. Must only run after stop_threads, no other thread may use them.
+* @date 17.04.2014 born
+* @date 17.10.2026 revised
+*
+*/ 
+void release_resources(void)
+{
 	// if meas_mode = record -> close fp now
 	if (fp_datalog != NULL)
 		fclose(fp_datalog);
@@ -133,324 +317,1416 @@ void sigintHandler(int sig_num){
 	if (fp_config != NULL)
 		fclose(fp_config);
 	
+	remove_shared_objects();
+	
 	//fclose(fp_rawlog);
-	printf("Exiting ...\n");
-	fclose(fp_console);
+	print_runtime_stats();
+	fprintf(fp_console, "Exiting ...\n");
 	
 	mpu9150_exit();
 	
-	exit(0);
+	fclose(fp_console);
 }
 
 
 /**
 * @brief Command handler for NMEA messages
-* @param sock Network socket handler
-* @return 
+* @param s buffer for sentences, NMEA_TICK_SIZE bytes
+* @param vs latest filtered values from fusion thread
+* @param sentences bit mask of SCHED_POV_* sentences due in this tick
+* @return length of all sentences
 * 
-* Message handler called by main-loop to generate timing of NMEA messages
+* Message handler called by the NMEA timer of the output thread
 * @date 17.04.2014 born
+* @date 17.10.2026 revised
 *
 */ 
-int NMEA_message_handler(int sock)
+int NMEA_message_handler(char *s, t_vario_sample *vs, int sentences)
 {
 	// some local variables
 	float vario;
-	int sock_err;
 
-	static int nmea_counter = 1;
 	int result;
-	char s[256];
-	
-	switch (nmea_counter)
-	{
-		case 5:
-		case 10:
-		case 15:
-		case 20:
-		case 25:
-		case 30:
-		case 35:
-		case 40:
-			// Compute Vario
-			vario = ComputeVario(vkf.x_abs_, vkf.x_vel_);
-			
-			if (config.output_POV_P_Q == 1)
+	int length;
+	int tick_length = 0;
+	
+	vario = vs->vario;
+	
+	// all sentences of this tick are collected in s and sent at once
+	if (sentences & (1 << SCHED_POV_P_Q))
+	{
+		// Compose POV slow NMEA sentences
+		result = Compose_Pressure_POV_slow(&s[tick_length], vs->p_static/100, vs->p_dynamic*100, &length);
+		tick_length += length;
+		
+		// NMEA sentence valid ?? Otherwise print some error !!
+		if (result != 1)
+		{
+			printf("POV slow NMEA Result = %d\n",result);
+		}	
+	}
+	
+	if (sentences & (1 << SCHED_POV_E))
+	{
+		if (vs->tep_valid != 1)
+		{
+			vario = 99;
+		}
+		// Compose POV slow NMEA sentences
+		result = Compose_Pressure_POV_fast(&s[tick_length], vario, &length);
+		tick_length += length;
+		
+		// NMEA sentence valid ?? Otherwise print some error !!
+		if (result != 1)
+		{
+			printf("POV fast NMEA Result = %d\n",result);
+		}	
+	}
+	
+	if ((sentences & (1 << SCHED_POV_V)) && voltage_sensor.present)
+	{
+
+		// Compose POV slow NMEA sentences
+		result = Compose_Voltage_POV(&s[tick_length], vs->voltage, &length);
+		tick_length += length;
+		
+		// NMEA sentence valid ?? Otherwise print some error !!
+		if (result != 1)
+		{
+			printf("POV voltage NMEA Result = %d\n",result);
+		}	
+	}
+	
+	return(tick_length);
+}
+
+/**
+* @brief Read all pressure sensors and the voltage with one I2C transfer
+* @return result
+*
+* Falls back to single transfers if the combined transfer fails, so one
+* missing device does not stall the others.
+* @date 17.10.2026 born
+*
+*/
+int read_pressure_sensors(void)
+{
+	static unsigned int voltage_count = 0;
+	t_i2c_batch batch;
+	int read_voltage = voltage_sensor.present;
+
+	// voltage is read less often under overload, pressures are always read
+	if (read_voltage && overload_level(&overload) >= OVERLOAD_VOLTAGE)
+		read_voltage = (voltage_count++ % OVERLOAD_VOLTAGE_DIVIDER) == 0;
+
+	i2c_batch_init(&batch);
+	ms5611_batch_read(&static_sensor, &batch);
+	ms5611_batch_read(&tep_sensor, &batch);
+	ams5915_batch_measure(&dynamic_sensor, &batch);
+	if(read_voltage)
+		ads1110_batch_measure(&voltage_sensor, &batch);
+
+	if (i2c_batch_run(&sensor_bus, &batch) != 0)
+	{
+		// read sensors one by one
+		pressure_bus_stats.fallbacks++;
+		ms5611_read_pressure(&static_sensor);
+		ms5611_read_pressure(&tep_sensor);
+		if (ams5915_measure(&dynamic_sensor) == 0)
+			ams5915_calculate(&dynamic_sensor);
+		if(read_voltage && ads1110_measure(&voltage_sensor) == 0)
+			ads1110_calculate(&voltage_sensor);
+		return 1;
+	}
+
+	// decode pressure values
+	ms5611_decode_pressure(&static_sensor);
+	ms5611_decode_pressure(&tep_sensor);
+
+	// decode AMS5915
+	ams5915_decode(&dynamic_sensor);
+	ams5915_calculate(&dynamic_sensor);
+
+	// decode ADS1110
+	if(read_voltage)
+	{
+		ads1110_decode(&voltage_sensor);
+		ads1110_calculate(&voltage_sensor);
+	}
+
+	return (0);
+}
+
+/**
+* @brief Start conversion or read temperature of both MS5611 in one transfer
+* @param cmd 0 for ADC read, else conversion command
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int ms5611_pair_command(int cmd)
+{
+	t_i2c_batch batch;
+
+	i2c_batch_init(&batch);
+	switch (cmd)
+	{
+		case MS5611_PAIR_START_PRESSURE:
+			ms5611_batch_start_pressure(&static_sensor, &batch);
+			ms5611_batch_start_pressure(&tep_sensor, &batch);
+			break;
+		case MS5611_PAIR_START_TEMP:
+			ms5611_batch_start_temp(&static_sensor, &batch);
+			ms5611_batch_start_temp(&tep_sensor, &batch);
+			break;
+		case MS5611_PAIR_READ_TEMP:
+			ms5611_batch_read(&static_sensor, &batch);
+			ms5611_batch_read(&tep_sensor, &batch);
+			break;
+	}
+
+	if (i2c_batch_run(&sensor_bus, &batch) != 0)
+		return 1;
+
+	if (cmd == MS5611_PAIR_READ_TEMP)
+	{
+		ms5611_decode_temp(&static_sensor);
+		ms5611_decode_temp(&tep_sensor);
+	}
+
+	return (0);
+}
+
+/**
+* @brief Account bus time of one tick or update
+* @param stats pointer to statistics
+* @param busy_ns sensor_bus.busy_ns before the bus access
+* @param transfers sensor_bus.transfers before the bus access
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void account_bus_stats(t_tick_bus_stats *stats, long long busy_ns, unsigned long transfers)
+{
+	busy_ns = sensor_bus.busy_ns - busy_ns;
+	if (sensor_bus.transfers != transfers)
+	{
+		stats->ticks++;
+		stats->transfers += sensor_bus.transfers - transfers;
+		stats->busy_ns += busy_ns;
+		if (busy_ns > stats->busy_max_ns)
+			stats->busy_max_ns = busy_ns;
+	}
+}
+
+/**
+* @brief Print bus time per tick or update
+* @param name name of statistics
+* @param stats pointer to statistics
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void print_bus_stats(const char *name, t_tick_bus_stats *stats)
+{
+	if (stats->ticks == 0)
+		return;
+	
+	fprintf(fp_console,"  %-8s updates: %lu transfers/update: %.2f bus time/update: avg %lldus max %lldus fallbacks: %lu\n",
+		name,
+		stats->ticks,
+		(float)stats->transfers / stats->ticks,
+		stats->busy_ns / stats->ticks / 1000,
+		stats->busy_max_ns / 1000,
+		stats->fallbacks);
+}
+
+/**
+* @brief Account age of sample at output
+* @param stats pointer to statistics
+* @param ts time at which the sample was read
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void update_age_stats(t_age_stats *stats, const struct timespec *ts)
+{
+	struct timespec now;
+	long long age;
+	
+	if (ts->tv_sec == 0 && ts->tv_nsec == 0)
+		return;
+	
+	timer_now(&now);
+	age = timespec_diff_ns(&now, ts);
+	
+	stats->count++;
+	stats->sum_ns += age;
+	if (age > stats->max_ns)
+		stats->max_ns = age;
+}
+
+/**
+* @brief Print sample age at output
+* @param name name of statistics
+* @param stats pointer to statistics
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void print_age_stats(const char *name, t_age_stats *stats)
+{
+	if (stats->count == 0)
+		return;
+	
+	fprintf(fp_console,"  %-8s sent: %lu sample age: avg %lldus max %lldus\n",
+		name,
+		stats->count,
+		stats->sum_ns / stats->count / 1000,
+		stats->max_ns / 1000);
+}
+
+/**
+* @brief Run transaction of pressure measurement cycle
+* @param arg MS5611_PAIR_* command or PRESSURE_READ_ALL
+* @return result
+*
+* Runs in the I2C worker thread.
+* @date 17.10.2026 born
+*
+*/
+int pressure_job(void *arg)
+{
+	int cmd = (int)(intptr_t)arg;
+	long long busy_ns = sensor_bus.busy_ns;
+	unsigned long transfers = sensor_bus.transfers;
+	int result;
+	
+	if (cmd == PRESSURE_READ_ALL)
+		result = read_pressure_sensors();
+	else
+		result = ms5611_pair_command(cmd);
+	
+	// account bus time of this tick
+	account_bus_stats(&pressure_bus_stats, busy_ns, transfers);
+	
+	return result;
+}
+
+/**
+* @brief Write raw and computed pressure values into shared memory sample ring
+* @param ts time at which the values were read
+* @return
+*
+* Runs in the I2C worker thread, the only producer of the sample ring.
+* @date 17.10.2026 born
+*
+*/
+void record_pressure_sample(const struct timespec *ts)
+{
+	t_sample_record *rec = sample_ring_reserve(&sample_ring, SAMPLE_RECORD_PRESSURE);
+	
+	if (rec == NULL)
+		return;
+	
+	rec->ts_ns = (int64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+	rec->pressure.static_d1 = static_sensor.D1;
+	rec->pressure.static_d2 = static_sensor.D2;
+	rec->pressure.tep_d1 = tep_sensor.D1;
+	rec->pressure.tep_d2 = tep_sensor.D2;
+	rec->pressure.p_static = static_sensor.p;
+	rec->pressure.p_tep = tep_sensor.p;
+	rec->pressure.p_dynamic = dynamic_sensor.p;
+	rec->pressure.digoutp = dynamic_sensor.digoutp;
+	rec->pressure.voltage_raw = voltage_sensor.voltage_raw;
+	rec->pressure.voltage = voltage_sensor.voltage_converted;
+	
+	if (static_sensor.valid)
+		rec->flags |= SAMPLE_STATIC_VALID;
+	if (tep_sensor.valid)
+		rec->flags |= SAMPLE_TEP_VALID;
+	if (dynamic_sensor.valid)
+		rec->flags |= SAMPLE_DYNAMIC_VALID;
+	if (voltage_sensor.present)
+		rec->flags |= SAMPLE_VOLTAGE_VALID;
+	
+	sample_ring_commit(&sample_ring);
+}
+
+/**
+* @brief Write DMP packets of one FIFO read into shared memory sample ring
+* @param ts time of IMU read
+* @param mpu raw IMU data
+* @return
+*
+* The packets are spread back from the read time by the sample rate, like
+* the vario filter does. Runs in the I2C worker thread.
+* @date 17.10.2026 born
+*
+*/
+void record_dmp_packets(const struct timespec *ts, const mpudata_t *mpu)
+{
+	t_sample_record *rec;
+	int rate = mpu9150_get_sample_rate();
+	int n = mpu->numPackets;
+	int i, j;
+	
+	for (i = 0; i < n; i++)
+	{
+		rec = sample_ring_reserve(&sample_ring, SAMPLE_RECORD_DMP);
+		if (rec == NULL)
+			return;
+		
+		rec->ts_ns = (int64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+		if (rate > 0)
+			rec->ts_ns -= (int64_t)(n - 1 - i) * NSEC_PER_SEC / rate;
+		
+		for (j = 0; j < 3; j++)
+		{
+			rec->dmp.raw_gyro[j] = mpu->packets[i].rawGyro[j];
+			rec->dmp.raw_accel[j] = mpu->packets[i].rawAccel[j];
+		}
+		for (j = 0; j < 4; j++)
+			rec->dmp.raw_quat[j] = mpu->packets[i].rawQuat[j];
+		rec->dmp.timestamp = mpu->packets[i].timestamp;
+		
+		sample_ring_commit(&sample_ring);
+	}
+}
+
+/**
+* @brief Pass current sensor values to fusion thread
+* @param ts time at which the values were read
+* @return
+*
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+void push_pressure_sample(const struct timespec *ts)
+{
+	t_pressure_sample sample;
+	
+	sample.ts = *ts;
+	sample.p_static = static_sensor.p;
+	sample.p_tep = tep_sensor.p;
+	sample.p_dynamic = dynamic_sensor.p;
+	sample.voltage = voltage_sensor.voltage_converted;
+	spsc_ring_push(&pressure_ring, &sample);
+	
+	record_pressure_sample(ts);
+}
+
+/**
+* @brief Completion callback of pressure read
+* @param arg unused
+* @param result result of pressure_job
+* @param completed end of I2C transfer
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void pressure_read_done(void *arg, int result, const struct timespec *completed)
+{
+	long long interval_ns = temp_refresh.interval_ns;
+	
+	push_pressure_sample(completed);
+	
+	// under overload the temperature is refreshed only at max. interval
+	if (overload_level(&overload) >= OVERLOAD_TEMP)
+		interval_ns = temp_refresh.max_ns;
+	
+	// refresh temperature before the next pressure conversion, so the
+	// pressure samples stay evenly spaced
+	if (timespec_diff_ns(completed, &temp_refresh.last) >= interval_ns)
+	{
+		temp_refresh.last = *completed;
+		i2c_queue_submit(&i2c_queue, &pressure_device, I2C_PRIO_TRIGGER, TRIGGER_DEADLINE_NS, pressure_job, conversion_start_done, (void *)MS5611_PAIR_START_TEMP);
+	}
+}
+
+/**
+* @brief Completion callback of temperature read
+* @param arg unused
+* @param result result of pressure_job
+* @param completed end of I2C transfer
+* @return
+*
+* Adapts the refresh interval to the drift of the temperature readings.
+* The interval is chosen so that the pressure error caused by the stale
+* temperature grows to max_error until the next refresh.
+* @date 17.10.2026 born
+*
+*/
+void temp_read_done(void *arg, int result, const struct timespec *completed)
+{
+	t_temp_refresh *r = &temp_refresh;
+	float dt, drift_static, drift_tep;
+	
+	if (result != 0)
+		return;
+	
+	r->refreshes++;
+	
+	if (r->ref_valid)
+	{
+		// drift over a longer time, as readings are noisy
+		dt = timespec_diff_ns(completed, &r->ref_ts) / 1e9;
+		if (dt * NSEC_PER_SEC < TEMP_DRIFT_WINDOW_NS)
+			return;
+		
+		drift_static = fabsf((static_sensor.dT - r->ref_dT[0]) * ms5611_pressure_per_dT(&static_sensor)) / dt;
+		drift_tep = fabsf((tep_sensor.dT - r->ref_dT[1]) * ms5611_pressure_per_dT(&tep_sensor)) / dt;
+		r->drift = (drift_static > drift_tep) ? drift_static : drift_tep;
+		
+		if (r->drift * r->max_ns / NSEC_PER_SEC <= r->max_error)
+			r->interval_ns = r->max_ns;
+		else
+			r->interval_ns = r->max_error / r->drift * NSEC_PER_SEC;
+		
+		if (r->interval_ns < r->min_ns)
+			r->interval_ns = r->min_ns;
+	}
+	
+	r->ref_ts = *completed;
+	r->ref_dT[0] = static_sensor.dT;
+	r->ref_dT[1] = tep_sensor.dT;
+	r->ref_valid = 1;
+}
+
+/**
+* @brief Completion callback of conversion start
+* @param arg MS5611_PAIR_START_PRESSURE or MS5611_PAIR_START_TEMP
+* @param result result of pressure_job
+* @param completed end of I2C transfer
+* @return
+*
+* Queues the read for the time the slower MS5611 finished its conversion,
+* instead of waiting for the next tick. Runs in the I2C worker thread.
+* @date 17.10.2026 born
+*
+*/
+void conversion_start_done(void *arg, int result, const struct timespec *completed)
+{
+	struct timespec release = *completed;
+	
+	// no conversion running, nothing to read
+	if (result != 0)
+		return;
+	
+	timespec_add_ns(&release, schedule.conversion_ns);
+	
+	if ((intptr_t)arg == MS5611_PAIR_START_PRESSURE)
+	{
+		// read pressure values, AMS5915 and ADS1110, sample is passed on by pressure_read_done
+		i2c_queue_submit_at(&i2c_queue, &pressure_device, I2C_PRIO_READ, &release, READ_DEADLINE_NS, pressure_job, pressure_read_done, (void *)PRESSURE_READ_ALL);
+	}
+	else
+	{
+		// read temp values
+		i2c_queue_submit_at(&i2c_queue, &pressure_device, I2C_PRIO_READ, &release, READ_DEADLINE_NS, pressure_job, temp_read_done, (void *)MS5611_PAIR_READ_TEMP);
+	}
+}
+
+/**
+* @brief Timming routine for pressure measurement
+* @param 
+* @return 
+* 
+* Timing handler to coordinate pressure measurement. Runs in the
+* acquisition thread and passes the raw values to the fusion thread.
+* Every tick runs the action of its slot in the compiled schedule, the
+* reads are queued by conversion_start_done and temperature refreshes
+* by pressure_read_done.
+* @date 17.04.2014 born
+* @date 17.10.2026 revised
+*
+*/ 
+void pressure_measurement_handler(void)
+{
+	static int meas_counter = 0;
+	struct timespec now;
+	
+	switch (schedule.slot[meas_counter])
+	{
+		case SCHED_PRESSURE_START:
+			if (io_mode.sensordata_from_file != TRUE)
 			{
-				// Compose POV slow NMEA sentences
-				result = Compose_Pressure_POV_slow(&s[0], p_static/100, p_dynamic*100);
-				
-				// NMEA sentence valid ?? Otherwise print some error !!
-				if (result != 1)
-				{
-					printf("POV slow NMEA Result = %d\n",result);
-				}	
-			
-				// Send NMEA string via socket to XCSoar
-				if ((sock_err = send(sock, s, strlen(s), 0)) < 0)
-				{	
-					fprintf(stderr, "send failed\n");
-					break;
-				}
+				// start pressure measurement
+				i2c_queue_submit(&i2c_queue, &pressure_device, I2C_PRIO_TRIGGER, TRIGGER_DEADLINE_NS, pressure_job, conversion_start_done, (void *)MS5611_PAIR_START_PRESSURE);
 			}
-			
-			if (config.output_POV_E == 1)
+			else
 			{
-				if (tep_sensor.valid != 1)
+				if (fscanf(fp_sensordata, "%f,%f,%f", &tep_sensor.p, &static_sensor.p, &dynamic_sensor.p) == EOF)
 				{
-					vario = 99;
-				}
-				// Compose POV slow NMEA sentences
-				result = Compose_Pressure_POV_fast(&s[0], vario);
-				
-				// NMEA sentence valid ?? Otherwise print some error !!
-				if (result != 1)
-				{
-					printf("POV fast NMEA Result = %d\n",result);
-				}	
-				
-				// Send NMEA string via socket to XCSoar
-				if ((sock_err = send(sock, s, strlen(s), 0)) < 0)
-				{	
-					fprintf(stderr, "send failed\n");
-					break;
+					// shut down like on SIGTERM, main cleans up
+					printf("End of File reached\n");
+					reactor_stop(&reactor);
+					break;
 				}
+				timer_now(&now);
+				push_pressure_sample(&now);
+			}
+			break;
+		
+		default:
+			break;
+	}
+	
+	// take care for statemachine counter
+	if (++meas_counter == schedule.slots)
+	{
+		meas_counter = 0;
+		ddebug_print("%s: start new cycle\n", __func__);
+	}
+}
+
+/**
+* @brief Publish filtered pressure values in shared memory snapshot
+* @param vs filtered values passed to output thread
+* @return 
+* 
+* Runs in the fusion thread, the only writer of the snapshot.
+* @date 17.10.2026 born
+*
+*/ 
+void snapshot_pressure_handler(const t_vario_sample *vs)
+{
+	t_snapshot_data *data = snapshot_begin(&snapshot);
+	
+	if (data == NULL)
+		return;
+	
+	data->pressure_ts_ns = (int64_t)vs->ts.tv_sec * NSEC_PER_SEC + vs->ts.tv_nsec;
+	data->p_static = vs->p_static;
+	data->p_dynamic = vs->p_dynamic;
+	data->vkf_x_abs = vkf.x_abs_;
+	data->vkf_x_vel = vkf.x_vel_;
+	data->vario = vs->vario;
+	data->voltage = vs->voltage;
+	
+	data->flags |= SNAPSHOT_PRESSURE_VALID;
+	data->flags &= ~(SNAPSHOT_TEP_VALID | SNAPSHOT_VARIO_IMU);
+	if (vs->tep_valid)
+		data->flags |= SNAPSHOT_TEP_VALID;
+	if (vbf_active)
+		data->flags |= SNAPSHOT_VARIO_IMU;
+	
+	snapshot_end(&snapshot);
+}
+
+/**
+* @brief Publish fused IMU values in shared memory snapshot
+* @param ts time of IMU read
+* @param mpu fused IMU data
+* @return 
+* 
+* @date 17.10.2026 born
+*
+*/ 
+void snapshot_imu_handler(const struct timespec *ts, const mpudata_t *mpu)
+{
+	t_snapshot_data *data = snapshot_begin(&snapshot);
+	
+	if (data == NULL)
+		return;
+	
+	data->imu_ts_ns = (int64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+	memcpy(data->fused_euler, mpu->fusedEuler, sizeof(data->fused_euler));
+	memcpy(data->fused_quat, mpu->fusedQuat, sizeof(data->fused_quat));
+	data->vert_accel = mpu->vertAccel;
+	memcpy(data->calibrated_accel, mpu->calibratedAccel, sizeof(data->calibrated_accel));
+	data->flags |= SNAPSHOT_IMU_VALID;
+	
+	snapshot_end(&snapshot);
+}
+
+/**
+* @brief Filtering of pressure values
+* @param sample raw values of one measurement cycle
+* @return 
+* 
+* Runs in the fusion thread for every sample from the acquisition thread
+* and passes the filtered values to the output thread. The filters use
+* the measured time between the samples, so a late or skipped tick does
+* not distort the vario.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/ 
+void pressure_fusion_handler(t_pressure_sample *sample)
+{
+	static struct timespec last_ts;
+	t_vario_sample out;
+	float dt, alpha;
+	
+	if (last_ts.tv_sec == 0 && last_ts.tv_nsec == 0)
+		dt = 1.0 / schedule.config.pressure_rate;
+	else
+		dt = timespec_diff_ns(&sample->ts, &last_ts) / 1e9;
+	last_ts = sample->ts;
+	
+	if (dt <= 0.0)
+		dt = 1.0 / schedule.config.pressure_rate;
+	else if (dt > PRESSURE_MAX_DT)
+		dt = PRESSURE_MAX_DT;
+	
+	// weight of new value, 1/4 at 20 Hz
+	alpha = 1.0 - expf(-dt / PRESSURE_SMOOTH_TAU);
+	
+	//
+	// filtering
+	//
+	// of static pressure
+	p_static += alpha * (sample->p_static - p_static);
+	
+	// check tep_pressure input value for validity
+	if ((sample->p_tep/100 < 100) || (sample->p_tep/100 > 1200))
+	{
+		// tep pressure out of range
+		tep_valid = 0;
+	}
+	else
+	{
+		// of tep pressure
+		KalmanFiler1d_update(&vkf, sample->p_tep/100, 0.25, dt);
+		
+		if (vbf_active)
+		{
+			if (timespec_diff_ns(&sample->ts, &vbf.t_) > VARIO_IMU_TIMEOUT_NS + NSEC_PER_SEC/imu_poll_rate)
+			{
+				// IMU data stopped, continue with pressure only filter
+				vbf_active = 0;
+				vbf_fallbacks++;
 			}
+			else
+				BaroInertialFilter_add_pressure(&vbf, &sample->ts, sample->p_tep/100);
+		}
+	}
+	
+	// of dynamic pressure
+	p_dynamic += alpha * (sample->p_dynamic - p_dynamic);
+	//printf("Pdyn: %f\n",p_dynamic*100);
+	// mask speeds < 10km/h
+	if (p_dynamic < 0.04)
+	{
+		p_dynamic = 0.0;
+	}
+		
+	// write pressure to file if option is set
+	if (io_mode.sensordata_to_file == TRUE)
+	{
+		fprintf(fp_datalog, "%f,%f,%f\n",  sample->p_tep/100, sample->p_static/100, sample->p_dynamic);
+	}
+	
+	// datalog
+	//fprintf(fp_rawlog,"%f,%f,%f\n",sample->p_tep/100, vkf.x_abs_, vkf.x_vel_);
+	
+	// pass values to output thread
+	out.ts = sample->ts;
+	out.p_static = p_static;
+	out.p_dynamic = p_dynamic;
+	if (vbf_active)
+		out.vario = ComputeVario(vbf.x_abs_, vbf.x_vel_);
+	else
+		out.vario = ComputeVario(vkf.x_abs_, vkf.x_vel_);
+	out.voltage = sample->voltage;
+	out.tep_valid = tep_valid;
+	spsc_ring_push(&vario_ring, &out);
+	
+	snapshot_pressure_handler(&out);
+}
+
+/**
+* AHRS_message: Compose sentence in NMEA format as
+* expected by XCSoar LevilAHRS Driver, returns its length:
+* $RPYL,Roll,Pitch,MagnHeading,SideSlip,YawRate,G,errorcode
+*
+* Error bits (not implemented yet):
+*   0: Roll gyro test failed  
+*   1: Roll gyro test failed 
+*   2: Roll gyro test failed 
+*   3: Acc X test failed 
+*   4: Acc Y test failed 
+*   5: Acc Z test failed 
+*   6: Watchdog test failed
+*   7: Ram test failed
+*   8: EEPROM access test failed
+*   9: EEPROM checksum test failed
+*  10: Flash checksum test failed
+*  11: Low voltage error
+*  12: High temperature error (>60 C)
+*  13: Inconsistent roll data between gyro and acc.
+*  14: Inconsistent pitch data between gyro and acc.
+*  15: Inconsistent yaw data between gyro and acc.
+*/
+int AHRS_message(char *s, size_t size, const t_ahrs_sample *mpu, t_mpu9150 *mpucal)
+{
+	return Compose_RPYL(s, size,
+			// orientations
+	       		((mpu->fusedEuler[VEC3_X] * RAD_TO_DEGREE) + mpucal->roll_adjust) * 10.,
+	       		((mpu->fusedEuler[VEC3_Y] * RAD_TO_DEGREE) + mpucal->pitch_adjust) * 10.,
+	       		((mpu->fusedEuler[VEC3_Z] * RAD_TO_DEGREE) + mpucal->yaw_adjust) * 10.,
+	
+			// sideslip & delta yaw don't seem to be used by XCSoar
+			// Magnitude of "G"
+			sqrt(
+				pow(mpu->calibratedAccel[VEC3_X], 2) + 
+				pow(mpu->calibratedAccel[VEC3_Y], 2) +
+			    pow(mpu->calibratedAccel[VEC3_Z], 2)
+			) * ((mpu->calibratedAccel[VEC3_Z] < 0.) ? -1000. : 1000.)
+	);
+}
+
+
+/**
+* @brief Poll rate of IMU FIFO
+* @param sample_rate FIFO sample rate (Hz)
+* @param output_rate AHRS output rate (Hz)
+* @return poll rate (Hz)
+*
+* Poll with output rate, but often enough to keep the FIFO less than
+* half full.
+* @date 17.10.2026 born
+*
+*/
+int get_imu_poll_rate(int sample_rate, int output_rate)
+{
+	int half_fifo = mpu9150_get_fifo_capacity(mpu_sensor.fusion) / 2;
+	
+	if (output_rate < 1)
+		output_rate = 1;
+	
+	if (sample_rate / output_rate > half_fifo)
+		return (sample_rate / half_fifo + 1);
+	
+	return (output_rate);
+}
+
+/**
+* @brief Compile schedule from config
+* @return result
+*
+* Also applies the oversampling ratio to both MS5611. The IMU bus load
+* is estimated from the configured rates, as the IMU is not set up yet.
+* @date 17.10.2026 born
+*
+*/
+int setup_schedule(void)
+{
+	t_schedule_config sc;
+	
+	sc.tick_rate = config.tick_rate;
+	sc.pressure_rate = config.pressure_rate;
+	// max. one temperature refresh per pressure sample
+	if (config.temp_min_interval < 1 || config.temp_max_interval < config.temp_min_interval)
+	{
+		fprintf(stderr, "Temperature refresh interval %d..%d ms invalid\n", config.temp_min_interval, config.temp_max_interval);
+		return 1;
+	}
+	sc.temp_rate = (1000 + config.temp_min_interval - 1) / config.temp_min_interval;
+	if (sc.temp_rate > config.pressure_rate)
+		sc.temp_rate = config.pressure_rate;
+	
+	memset(&temp_refresh, 0, sizeof(t_temp_refresh));
+	temp_refresh.min_ns = (long long)config.temp_min_interval * 1000000;
+	temp_refresh.max_ns = (long long)config.temp_max_interval * 1000000;
+	temp_refresh.interval_ns = temp_refresh.min_ns;
+	temp_refresh.max_error = config.temp_max_error;
+	sc.static_osr = static_sensor.osr;
+	sc.tep_osr = tep_sensor.osr;
+	sc.sentence_rate[SCHED_POV_P_Q] = config.output_POV_P_Q ? config.output_POV_P_Q_rate : 0;
+	sc.sentence_rate[SCHED_POV_E] = config.output_POV_E ? config.output_POV_E_rate : 0;
+	sc.sentence_rate[SCHED_POV_V] = config.output_POV_V ? config.output_POV_V_rate : 0;
+	sc.imu_sample_rate = mpu_sensor.sample_rate;
+	sc.imu_poll_rate = get_imu_poll_rate(mpu_sensor.sample_rate, mpu_sensor.output_rate);
+	sc.imu_packet_length = mpu9150_get_packet_length(mpu_sensor.fusion);
+	sc.i2c_clock = config.i2c_clock;
+	
+	if (schedule_compile(&schedule, &sc) != 0)
+		return 1;
+	
+	ms5611_set_osr(&static_sensor, static_sensor.osr);
+	ms5611_set_osr(&tep_sensor, tep_sensor.osr);
+	return (0);
+}
+
+/**
+* @brief Event handler for main loop tick
+* @param arg unused
+* @return 
+* 
+* Called by the tick timer of the acquisition thread with the tick rate
+* of the schedule to drive the pressure measurement statemachine.
+* @date 17.10.2026 born
+*
+*/ 
+void tick_event_handler(void *arg)
+{
+	pressure_measurement_handler();
+}
+
+/**
+* @brief Read DMP FIFO and compass, runs in I2C worker thread
+* @param arg unused
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int imu_job(void *arg)
+{
+	long long busy_ns = sensor_bus.busy_ns;
+	unsigned long transfers = sensor_bus.transfers;
+	int result;
+	
+	result = mpu9150_read_raw(&mpu);
+	account_bus_stats(&imu_bus_stats, busy_ns, transfers);
+	
+	return result;
+}
+
+void imu_read_done(void *arg, int result, const struct timespec *completed)
+{
+	t_imu_sample sample;
+	int rate = mpu9150_get_sample_rate();
+	int first = 0, n;
+	
+	if (result == 0)
+	{
+		memcpy(sample.rawMag, mpu.rawMag, sizeof(sample.rawMag));
+		sample.magTimestamp = mpu.magTimestamp;
+		
+		// only the packets of this read are copied, in ring sized pieces
+		do
+		{
+			n = mpu.numPackets - first;
+			if (n > IMU_SAMPLE_PACKETS)
+				n = IMU_SAMPLE_PACKETS;
 			
-			if (config.output_POV_V == 1 && voltage_sensor.present)
+			sample.ts = *completed;
+			if (rate > 0)
+				timespec_add_ns(&sample.ts, -(long long)(mpu.numPackets - first - n) * NSEC_PER_SEC / rate);
+			
+			if (n > 0)
 			{
+				memcpy(sample.packets, &mpu.packets[first], n * sizeof(dmp_packet_t));
+				memcpy(sample.rawGyro, sample.packets[n - 1].rawGyro, sizeof(sample.rawGyro));
+				memcpy(sample.rawAccel, sample.packets[n - 1].rawAccel, sizeof(sample.rawAccel));
+				memcpy(sample.rawQuat, sample.packets[n - 1].rawQuat, sizeof(sample.rawQuat));
+				sample.dmpTimestamp = sample.packets[n - 1].timestamp;
+			}
+			else
+			{
+				memcpy(sample.rawGyro, mpu.rawGyro, sizeof(sample.rawGyro));
+				memcpy(sample.rawAccel, mpu.rawAccel, sizeof(sample.rawAccel));
+				memcpy(sample.rawQuat, mpu.rawQuat, sizeof(sample.rawQuat));
+				sample.dmpTimestamp = mpu.dmpTimestamp;
+			}
+			sample.numPackets = n;
+			
+			spsc_ring_push(&imu_ring, &sample);
+			first += n;
+		} while (first < mpu.numPackets);
+		
+		record_dmp_packets(completed, &mpu);
+	}
+	
+	__atomic_store_n(&imu_job_pending, 0, __ATOMIC_RELEASE);
+}
 
-				// Compose POV slow NMEA sentences
-				result = Compose_Voltage_POV(&s[0], voltage_sensor.voltage_converted);
-				
-				// NMEA sentence valid ?? Otherwise print some error !!
-				if (result != 1)
-				{
-					printf("POV voltage NMEA Result = %d\n",result);
-				}	
-				
-				// Send NMEA string via socket to XCSoar
-				if ((sock_err = send(sock, s, strlen(s), 0)) < 0)
-				{	
-					fprintf(stderr, "send failed\n");
-					break;
-				}
+/**
+* @brief Queue IMU read, unless one is still pending
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void imu_submit(void)
+{
+	if (__atomic_exchange_n(&imu_job_pending, 1, __ATOMIC_ACQ_REL))
+		return;
+	
+	// FIFO bursts queue behind the conversion triggers of the pressure sensors
+	if (i2c_queue_submit(&i2c_queue, &imu_device, I2C_PRIO_BULK, NSEC_PER_SEC/imu_poll_rate, imu_job, imu_read_done, NULL) != 0)
+		__atomic_store_n(&imu_job_pending, 0, __ATOMIC_RELEASE);
+}
+
+/**
+* @brief Event handler for IMU read
+* @param arg unused
+* @return 
+* 
+* Called by the IMU timer of the acquisition thread with imu_poll_rate,
+* or as watchdog in interrupt mode.
+* @date 17.10.2026 revised
+*
+*/ 
+void imu_event_handler(void *arg)
+{
+	static unsigned long events_seen = 0;
+	
+	if (imu_int_mode)
+	{
+		// watchdog: read anyway if an edge got lost
+		if (mpu_int_line.events == events_seen)
+		{
+			imu_watchdog_reads++;
+			imu_submit();
+		}
+		events_seen = mpu_int_line.events;
+		return;
+	}
+	
+	imu_submit();
+}
+
+void imu_int_event_handler(void *arg)
+{
+	if (gpio_line_read_events(&mpu_int_line) > 0)
+		imu_submit();
+}
+
+/**
+* @brief Event handler for pressure samples in fusion thread
+* @param arg unused
+* @return 
+* 
+* @date 17.10.2026 born
+*
+*/ 
+void pressure_ring_event_handler(void *arg)
+{
+	t_pressure_sample sample;
+	
+	spsc_ring_clear_event(&pressure_ring);
+	while (spsc_ring_pop(&pressure_ring, &sample) == 0)
+		pressure_fusion_handler(&sample);
+}
+
+/**
+* @brief Feed vertical acceleration into vario filter
+* @param ts time of IMU read
+* @param mpu fused IMU data
+* @return 
+* 
+* Runs in the fusion thread, like the pressure filtering. The packets of
+* one read are spread back from the read time by the sample rate. The
+* filter starts from the state of the pressure only filter, so the
+* vario does not jump when IMU data appears.
+* @date 17.10.2026 born
+*
+*/ 
+void vario_imu_handler(const struct timespec *ts, mpudata_t *mpu)
+{
+	struct timespec t;
+	int rate = mpu9150_get_sample_rate();
+	int n = mpu->numPackets;
+	int i;
+	
+	if (!config.vario_imu || rate <= 0)
+		return;
+	
+	if (!vbf_active)
+	{
+		BaroInertialFilter_reset(&vbf, vkf.x_abs_, vkf.x_vel_);
+		vbf.var_accel_ = config.vario_accel_var;
+		vbf.var_bias_ = BARO_INERTIAL_BIAS_VAR;
+		vbf.var_z_abs_ = config.vario_baro_var;
+		vbf_active = 1;
+	}
+	
+	for (i = 0; i < n; i++)
+	{
+		t = *ts;
+		timespec_add_ns(&t, -(long long)(n - 1 - i) * NSEC_PER_SEC / rate);
+		BaroInertialFilter_add_accel(&vbf, &t, mpu->packets[i].vertAccel);
+	}
+}
+
+/**
+* @brief Event handler for IMU samples in fusion thread
+* @param arg unused
+* @return 
+* 
+* The yaw state of the fusion lives in mpu_fused, only the raw values
+* are taken from the sample.
+* @date 17.10.2026 born
+*
+*/ 
+void imu_ring_event_handler(void *arg)
+{
+	t_imu_sample sample;
+	t_ahrs_sample ahrs;
+	int decimation;
+	
+	spsc_ring_clear_event(&imu_ring);
+	while (spsc_ring_pop(&imu_ring, &sample) == 0)
+	{
+		memcpy(mpu_fused.rawGyro, sample.rawGyro, sizeof(mpu_fused.rawGyro));
+		memcpy(mpu_fused.rawAccel, sample.rawAccel, sizeof(mpu_fused.rawAccel));
+		memcpy(mpu_fused.rawQuat, sample.rawQuat, sizeof(mpu_fused.rawQuat));
+		memcpy(mpu_fused.rawMag, sample.rawMag, sizeof(mpu_fused.rawMag));
+		mpu_fused.dmpTimestamp = sample.dmpTimestamp;
+		mpu_fused.magTimestamp = sample.magTimestamp;
+		memcpy(mpu_fused.packets, sample.packets, sample.numPackets * sizeof(dmp_packet_t));
+		mpu_fused.numPackets = sample.numPackets;
+		
+		if (mpu9150_fuse(&mpu_fused) == 0)
+		{
+			vario_imu_handler(&sample.ts, &mpu_fused);
+			snapshot_imu_handler(&sample.ts, &mpu_fused);
+			
+			// decimate to output rate, every packet counts as one sample
+			// the output rate is lowered first under overload
+			decimation = ahrs_decimation;
+			if (overload_level(&overload) >= OVERLOAD_AHRS)
+				decimation *= OVERLOAD_AHRS_FACTOR;
+			
+			ahrs_decimation_count += (mpu_fused.numPackets > 0) ? mpu_fused.numPackets : 1;
+			if (ahrs_decimation_count >= decimation)
+			{
+				ahrs_decimation_count %= decimation;
+				ahrs.ts = sample.ts;
+				memcpy(ahrs.fusedEuler, mpu_fused.fusedEuler, sizeof(ahrs.fusedEuler));
+				memcpy(ahrs.fusedQuat, mpu_fused.fusedQuat, sizeof(ahrs.fusedQuat));
+				memcpy(ahrs.calibratedAccel, mpu_fused.calibratedAccel, sizeof(ahrs.calibratedAccel));
+				spsc_ring_push(&ahrs_ring, &ahrs);
 			}
-			break;
-		default:
-			break;
+		}
+	}
+}
+
+/**
+* @brief Event handler for filtered values in output thread
+* @param arg unused
+* @return 
+* 
+* Only the latest values are kept for the next NMEA output.
+* @date 17.10.2026 born
+*
+*/ 
+void vario_ring_event_handler(void *arg)
+{
+	spsc_ring_clear_event(&vario_ring);
+	while (spsc_ring_pop(&vario_ring, &vario_state) == 0)
+		;
+}
+
+/**
+* @brief Check if anybody receives an output stream
+* @param conn connection used in client mode
+* @param server server used in server mode
+* @param udp UDP output
+* @param uds Unix domain socket output
+* @return 1 if connected
+*
+* An open UDP output counts as receiver, nobody knows who listens.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int output_active(t_conn *conn, t_server *server, t_udp_sink *udp, t_uds_server *uds)
+{
+	if (udp_sink_active(udp) || uds_server_clients(uds) > 0)
+		return 1;
+	
+	if (config.output_server)
+		return (server_clients(server) > 0);
+	
+	return conn_connected(conn);
+}
+
+/**
+* @brief Send sentences of an output stream to all its consumers
+* @param conn connection used in client mode
+* @param server server used in server mode
+* @param udp UDP output
+* @param uds Unix domain socket output
+* @param buf sentences
+* @param len number of bytes
+* @return 0 if sent to at least one consumer
+*
+* Local clients of the Unix domain socket get buf as one message.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int output_send(t_conn *conn, t_server *server, t_udp_sink *udp, t_uds_server *uds, const char *buf, size_t len)
+{
+	int result;
+	
+	if (config.output_server)
+		result = server_send(server, buf, len);
+	else
+		result = conn_send(conn, buf, len);
+	
+	if (udp_sink_active(udp) && udp_sink_send(udp, buf, len) == 0)
+		result = 0;
+	
+	if (uds_server_clients(uds) > 0 && uds_server_send(uds, buf, len) == 0)
+		result = 0;
+	
+	return result;
+}
+
+/**
+* @brief Event handler for NMEA output
+* @param arg unused
+* @return 
+* 
+* Called by the NMEA timer of the output thread with the output rate of
+* the schedule, sends the sentences due in this tick. Runs also while
+* XCSoar is not connected, so the schedule keeps its phase.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/ 
+void nmea_event_handler(void *arg)
+{
+	static int output_counter = 0;
+	int sentences = schedule.output[output_counter];
+	char s[NMEA_TICK_SIZE];
+	int length;
+	
+	if (++output_counter == schedule.output_slots)
+		output_counter = 0;
+	
+	if (!output_active(&xcsoar_conn, &ov_server, &ov_udp, &ov_uds))
+		return;
+	
+	// encoded once for all consumers
+	length = NMEA_message_handler(s, &vario_state, sentences);
+	if (length > 0 && output_send(&xcsoar_conn, &ov_server, &ov_udp, &ov_uds, s, length) == 0)
+		update_age_stats(&vario_age_stats, &vario_state.ts);
+}
+
+/**
+* @brief Event handler for fused IMU data in output thread
+* @param arg unused
+* @return 
+* 
+* All samples queued since the last wakeup are sent with one write.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/ 
+void ahrs_ring_event_handler(void *arg)
+{
+	t_ahrs_sample sample;
+	char s[AHRS_BATCH_SIZE];
+	int length = 0;
+	
+	spsc_ring_clear_event(&ahrs_ring);
+	while (spsc_ring_pop(&ahrs_ring, &sample) == 0)
+	{
+		// attitude data is discarded while not connected
+		if(!output_active(&ahrs_conn, &ahrs_server, &ahrs_udp, &ahrs_uds))
+			continue;
+		
+		// older samples are dropped, if more are queued than fit
+		if (length + AHRS_MESSAGE_SIZE > AHRS_BATCH_SIZE)
+			length = 0;
+		
+		length += AHRS_message(&s[length], AHRS_MESSAGE_SIZE, &sample, &mpu_sensor);
+		update_age_stats(&ahrs_age_stats, &sample.ts);
+	}
+	
+	if (length > 0)
+		output_send(&ahrs_conn, &ahrs_server, &ahrs_udp, &ahrs_uds, s, length);
+}
+
+/**
+* @brief Event handler for connection management in output thread
+* @param arg unused
+* @return 
+* 
+* Connects without blocking and retries with backoff, so the output
+* thread keeps draining the pipeline while XCSoar is not listening. In
+* server mode only the output buffers of the clients are flushed.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/ 
+void conn_event_handler(void *arg)
+{
+	if (config.output_server)
+	{
+		server_poll(&ov_server);
+		server_poll(&ahrs_server);
+		return;
 	}
 	
-	// take care for statemachine counter
-	if (nmea_counter == 40)
-			nmea_counter = 1;
-		else
-			nmea_counter++;
-		
-	return(sock_err);
-		
+	conn_poll(&xcsoar_conn);
+	conn_poll(&ahrs_conn);
 }
 
 /**
-* @brief Timming routine for pressure measurement
-* @param 
+* @brief Event handler for new clients in server mode
+* @param arg pointer to server
 * @return 
 * 
-* Timing handler to coordinate pressure measurement
-* @date 17.04.2014 born
+* @date 17.10.2026 born
 *
 */ 
-void pressure_measurement_handler(void)
+void accept_event_handler(void *arg)
 {
-	static int meas_counter = 1;
-	switch (meas_counter)
-	{
-		case 1:
-		case 5:
-		case 9:
-		case 13:
-		case 17:
-		case 21:
-		case 25:
-		case 29:
-		case 33:
-		case 37:
-			if (io_mode.sensordata_from_file != TRUE)
-			{
-				// start pressure measurement
-				ms5611_start_pressure(&static_sensor);
-				ms5611_start_pressure(&tep_sensor);
-			}
+	server_accept((t_server *)arg);
+}
+
+/**
+* @brief Event handler for new clients of Unix domain socket output
+* @param arg pointer to server
+* @return 
+* 
+* @date 17.10.2026 born
+*
+*/ 
+void uds_accept_event_handler(void *arg)
+{
+	uds_server_accept((t_uds_server *)arg);
+}
+
+/**
+* @brief Event handler for signals
+* @param arg unused
+* @return 
+* 
+* SIGUSR1 prints the runtime statistics. SIGINT and SIGTERM stop the
+* acquisition loop, main then shuts down the other threads and cleans up.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/ 
+void signal_event_handler(void *arg)
+{
+	struct signalfd_siginfo si;
+	
+	if (read(signal_fd, &si, sizeof(si)) != sizeof(si))
+		return;
+	
+	switch (si.ssi_signo)
+	{
+		case SIGUSR1:
+			print_runtime_stats();
 			break;
 		
-		case 2:
-		case 6:
-		case 10:
-		case 14:
-		case 18:
-		case 22:
-		case 26:
-		case 30:
-		case 34:
-		case 38:
-			if (io_mode.sensordata_from_file != TRUE)
-			{
-				// read pressure values
-				ms5611_read_pressure(&static_sensor);
-				ms5611_read_pressure(&tep_sensor);
-							
-				// read AMS5915
-				ams5915_measure(&dynamic_sensor);
-				ams5915_calculate(&dynamic_sensor);
-				
-				// read ADS1110
-				if(voltage_sensor.present)
-				{
-					ads1110_measure(&voltage_sensor);
-					ads1110_calculate(&voltage_sensor);
-				}
-			}
-			else
-			{
-				if (fscanf(fp_sensordata, "%f,%f,%f", &tep_sensor.p, &static_sensor.p, &dynamic_sensor.p) == EOF)
-				{
-					printf("End of File reached\n");
-					printf("Exiting ...\n");
-					exit(EXIT_SUCCESS);
-				}
-			}
-			
-			//
-			// filtering
-			//
-			// of static pressure
-			p_static = (3*p_static + static_sensor.p) / 4;
-			
-			// check tep_pressure input value for validity
-			if ((tep_sensor.p/100 < 100) || (tep_sensor.p/100 > 1200))
-			{
-				// tep pressure out of range
-				tep_sensor.valid = 0;
-			}
-			else
-			{
-				// of tep pressure
-				KalmanFiler1d_update(&vkf, tep_sensor.p/100, 0.25, 0.05);
-			}
-			
-			// of dynamic pressure
-			p_dynamic = (3*p_dynamic + dynamic_sensor.p) / 4;
-			//printf("Pdyn: %f\n",p_dynamic*100);
-			// mask speeds < 10km/h
-			if (p_dynamic < 0.04)
-			{
-				p_dynamic = 0.0;
-			}
-				
-			// write pressure to file if option is set
-			if (io_mode.sensordata_to_file == TRUE)
-			{
-				fprintf(fp_datalog, "%f,%f,%f\n",  tep_sensor.p/100, static_sensor.p/100, dynamic_sensor.p);
-			}
-			
-			// datalog
-			//fprintf(fp_rawlog,"%f,%f,%f\n",tep_sensor.p/100, vkf.x_abs_, vkf.x_vel_);
-			
-			break;
-		case 3:
-			// start temp measurement
-			ms5611_start_temp(&static_sensor);
-			ms5611_start_temp(&tep_sensor);
-			break;
-		case 4:
-			// read temp values
-			ms5611_read_temp(&static_sensor);
-			ms5611_read_temp(&tep_sensor);
+		case SIGINT:
+		case SIGTERM:
+			reactor_stop(&reactor);
 			break;
+		
 		default:
 			break;
 	}
-	
-	// take care for statemachine counter
-	if (meas_counter == 40)
-	{
-		meas_counter = 1;
-		ddebug_print("%s: start new cycle\n", __func__);
-	}
-	else
-	{
-		meas_counter++;
-	}
 }
 
 /**
-* AHRS_message: Output in NMEA format as
-* expected by XCSoar LevilAHRS Driver:
-* $RPYL,Roll,Pitch,MagnHeading,SideSlip,YawRate,G,errorcode
+* @brief Event handler for periodic statistics
+* @param arg unused
+* @return 
+* 
+* @date 17.10.2026 born
 *
-* Error bits (not implemented yet):
-*   0: Roll gyro test failed  
-*   1: Roll gyro test failed 
-*   2: Roll gyro test failed 
-*   3: Acc X test failed 
-*   4: Acc Y test failed 
-*   5: Acc Z test failed 
-*   6: Watchdog test failed
-*   7: Ram test failed
-*   8: EEPROM access test failed
-*   9: EEPROM checksum test failed
-*  10: Flash checksum test failed
-*  11: Low voltage error
-*  12: High temperature error (>60 C)
-*  13: Inconsistent roll data between gyro and acc.
-*  14: Inconsistent pitch data between gyro and acc.
-*  15: Inconsistent yaw data between gyro and acc.
-*/
-void AHRS_message(mpudata_t *mpu, t_mpu9150 *mpucal, int sock)
+*/ 
+void stats_event_handler(void *arg)
 {
+	print_runtime_stats();
+}
+
+/**
+* @brief Event handler for load shedding
+* @param arg unused
+* @return 
+* 
+* Sums the deadline misses of the acquisition timers, the NMEA output and
+* the I2C transactions and updates the shedding level once per window. The TE
+* and static pressure path is never shed.
+* @date 17.10.2026 born
+*
+*/ 
+void overload_event_handler(void *arg)
+{
+	unsigned long long misses;
+	int level = overload_level(&overload);
 	
-	int sock_err;
-	char s[256];
+	misses = tick_event.stats.misses + tick_event.stats.overruns +
+		imu_event.stats.misses + imu_event.stats.overruns +
+		__atomic_load_n(&nmea_event.stats.misses, __ATOMIC_RELAXED) +
+		__atomic_load_n(&pressure_device.misses, __ATOMIC_RELAXED) +
+		__atomic_load_n(&imu_device.misses, __ATOMIC_RELAXED);
 	
-	sprintf(s, "$RPYL,%0.0f,%0.0f,%0.0f,0,0,%0.0f,0\r\n",
-			// orientations
-	       		((mpu->fusedEuler[VEC3_X] * RAD_TO_DEGREE) + mpucal->roll_adjust) * 10.,
-	       		((mpu->fusedEuler[VEC3_Y] * RAD_TO_DEGREE) + mpucal->pitch_adjust) * 10.,
-	       		((mpu->fusedEuler[VEC3_Z] * RAD_TO_DEGREE) + mpucal->yaw_adjust) * 10.,
+	if (overload_update(&overload, misses) != level)
+		debug_print("Shedding level %d (%s)\n", overload_level(&overload), overload_level_name(overload_level(&overload)));
+}
+
+/**
+* @brief Fusion thread
+* @param arg unused
+* @return 
+* 
+* Filters pressure values and fuses IMU data as they arrive from the
+* acquisition thread.
+* @date 17.10.2026 born
+*
+*/ 
+void *fusion_thread(void *arg)
+{
+	reactor_run(&fusion_reactor);
+	return NULL;
+}
+
+/**
+* @brief Output thread
+* @param arg unused
+* @return 
+* 
+* Sends the NMEA sentences to XCSoar and the attitude to the LevilAHRS
+* driver. Connections are made and remade by conn_event_handler, while
+* acquisition and fusion keep running.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/ 
+void *output_thread(void *arg)
+{
+	reactor_run(&output_reactor);
 	
-			// sideslip & delta yaw don't seem to be used by XCSoar
-			// Magnitude of "G"
-			sqrt(
-				pow(mpu->calibratedAccel[VEC3_X], 2) + 
-				pow(mpu->calibratedAccel[VEC3_Y], 2) +
-			    pow(mpu->calibratedAccel[VEC3_Z], 2)
-			) * ((mpu->calibratedAccel[VEC3_Z] < 0.) ? -1000. : 1000.)
-	);
+	conn_close(&xcsoar_conn);
+	conn_close(&ahrs_conn);
 	
-	// Send NMEA string via socket to XCSoar
-	if ((sock_err = send(sock, s, strlen(s), 0)) < 0)
-	{	
-		fprintf(stderr, "send failed\n");
+	// servers are only set up in server mode, their fds are 0 otherwise
+	if (config.output_server)
+	{
+		server_close(&ov_server);
+		server_close(&ahrs_server);
 	}
+	udp_sink_close(&ov_udp);
+	udp_sink_close(&ahrs_udp);
+	uds_server_close(&ov_uds);
+	uds_server_close(&ahrs_uds);
 	
-	
+	return NULL;
 }
 
-	
 int main (int argc, char **argv) {
 	
 	// local variables
 	int i=0;
 	int result;
-	int sock_err = 0;
-	
-	int sock_imu_connected = 0;
-	struct timeval imu_last_sample, curr_time;
+	int mpu_initialised = 0;
+	int sample_rate;
+	sigset_t sigmask;
 		
 	t_24c16 eeprom;
 	t_eeprom_data data;
 	
-	mpudata_t mpu;
 	t_mpu9150_cal accel_cal;
 	t_mpu9150_cal mag_cal;
 	
@@ -460,28 +1736,58 @@ int main (int argc, char **argv) {
 
 	io_mode.sensordata_from_file = FALSE;
 	io_mode.sensordata_to_file = FALSE;
-	
-	// signals and action handlers
-	struct sigaction sigact;
-	
-	// socket communication
-	int sock;
-	int sock_imu;
-	struct sockaddr_in server;
-	struct sockaddr_in server_imu;
+	io_mode.benchmark = FALSE;
 	
 	// initialize variables
 	static_sensor.offset = 0.0;
 	static_sensor.linearity = 1.0;
+	static_sensor.osr = MS5611_DEFAULT_OSR;
 	
 	dynamic_sensor.offset = 0.0;
 	dynamic_sensor.linearity = 1.0;
 	
 	tep_sensor.offset = 0.0;
 	tep_sensor.linearity = 1.0;
+	tep_sensor.osr = MS5611_DEFAULT_OSR;
 	
 	config.output_POV_E = 0;
 	config.output_POV_P_Q = 0;
+	config.output_POV_V = 0;
+	config.output_POV_E_rate = NMEA_SEND_RATE;
+	config.output_POV_P_Q_rate = NMEA_SEND_RATE;
+	config.output_POV_V_rate = NMEA_SEND_RATE;
+	config.tick_rate = TICK_RATE;
+	config.pressure_rate = PRESSURE_SAMPLE_RATE;
+	config.temp_min_interval = TEMP_MIN_INTERVAL_MS;
+	config.temp_max_interval = TEMP_MAX_INTERVAL_MS;
+	config.temp_max_error = TEMP_MAX_ERROR;
+	config.i2c_clock = SCHED_I2C_CLOCK;
+	config.rt_enable = 0;
+	config.rt_priority = RT_PRIORITY;
+	config.cpu_acquisition = -1;
+	config.cpu_i2c = -1;
+	config.cpu_fusion = -1;
+	config.cpu_output = -1;
+	config.output_server = 0;
+	strcpy(config.server_address, "127.0.0.1");
+	config.udp_enable = 0;
+	strcpy(config.udp_address, "239.0.0.1");
+	config.udp_ov_port = OV_PORT;
+	config.udp_ahrs_port = AHRS_PORT;
+	config.udp_ttl = 1;
+	strcpy(config.udp_interface, "any");
+	config.uds_enable = 0;
+	strcpy(config.uds_ov_path, "/run/sensord-pov.sock");
+	strcpy(config.uds_ahrs_path, "/run/sensord-ahrs.sock");
+	config.uds_allow_uid = -1;
+	config.snapshot_enable = 0;
+	strcpy(config.snapshot_name, SNAPSHOT_NAME);
+	config.samples_enable = 0;
+	strcpy(config.samples_name, SAMPLE_RING_NAME);
+	config.samples_slots = SAMPLE_RING_SLOTS;
+	config.vario_imu = 1;
+	config.vario_accel_var = BARO_INERTIAL_ACCEL_VAR;
+	config.vario_baro_var = BARO_INERTIAL_PRESSURE_VAR;
 	
 	
 	for(i=0;i<3;i++) {
@@ -497,6 +1803,11 @@ int main (int argc, char **argv) {
 	mpu_sensor.roll_adjust = 0.0;
 	mpu_sensor.pitch_adjust = 0.0;
 	mpu_sensor.yaw_adjust = 0.0;
+	mpu_sensor.fifo_burst = 1;
+	mpu_sensor.fusion = MPU9150_FUSION_DMP;
+	mpu_sensor.sample_rate = MPU_SAMPLE_RATE;
+	mpu_sensor.output_rate = AHRS_SAMPLE_RATE_HZ;
+	mpu_sensor.yaw_time_constant = AHRS_YAW_TIME_CONSTANT;
 
 
 	
@@ -506,19 +1817,26 @@ int main (int argc, char **argv) {
 	//parse command line arguments
 	cmdline_parser(argc, argv, &io_mode);
 	
+	// benchmarks run without sensors and config
+	if (io_mode.benchmark == TRUE)
+		return benchmark_run(stdout);
+	
 	// get config file options
 	if (fp_config != NULL)
 		cfgfile_parser(fp_config, &static_sensor, &tep_sensor, &dynamic_sensor, &voltage_sensor, &mpu_sensor, &config);
 	
+	// build measurement and output schedule, refuse to run an infeasible one
+	if (setup_schedule() != 0)
+	{
+		schedule_print_report(&schedule, stderr);
+		exit(EXIT_FAILURE);
+	}
+	
 	// check if we are a daemon or stay in foreground
 	if (g_foreground == TRUE)
 	{
 		// stay in foreground
-		// install signal handler for CTRL-C
-		sigact.sa_handler = sigintHandler;
-		sigemptyset (&sigact.sa_mask);
-		sigact.sa_flags = 0;
-		sigaction(SIGINT, &sigact, NULL);
+		// CTRL-C is handled via signalfd, see signal_event_handler
 		
 		// open console again, but as file_pointer
 		fp_console = stdout;
@@ -573,9 +1891,16 @@ int main (int argc, char **argv) {
 	// ignore SIGPIPE
 	signal(SIGPIPE, SIG_IGN);
 	
+	// open I2C bus for all sensors and the MPU9150 driver
+	if (i2c_bus_open(&sensor_bus, I2C_BUS) != 0)
+	{
+		fprintf(stderr, "Open I2C bus failed !!\n");
+	}
+	linux_set_i2c_bus_handle(&sensor_bus);
+	
 	// get config from EEPROM
 	// open eeprom object
-	result = eeprom_open(&eeprom, 0x50);
+	result = eeprom_open(&eeprom, &sensor_bus, 0x50);
 	if (result != 0)
 	{
 		printf("No EEPROM found !!\n");
@@ -610,7 +1935,7 @@ int main (int argc, char **argv) {
 		// we need hardware sensors for running !!
 		// open sensor for static pressure
 		/// @todo remove hardcoded i2c address static pressure
-		if (ms5611_open(&static_sensor, 0x76) != 0)
+		if (ms5611_open(&static_sensor, &sensor_bus, 0x76) != 0)
 		{
 			fprintf(stderr, "Open sensor failed !!\n");
 			return 1;
@@ -625,7 +1950,7 @@ int main (int argc, char **argv) {
 				
 		// open sensor for velocity pressure
 		/// @todo remove hardcoded i2c address for velocity pressure
-		if (ms5611_open(&tep_sensor, 0x77) != 0)
+		if (ms5611_open(&tep_sensor, &sensor_bus, 0x77) != 0)
 		{
 			fprintf(stderr, "Open sensor failed !!\n");
 			return 1;
@@ -640,7 +1965,7 @@ int main (int argc, char **argv) {
 		
 		// open sensor for differential pressure
 		/// @todo remove hardcoded i2c address for differential pressure
-		if (ams5915_open(&dynamic_sensor, 0x28) != 0)
+		if (ams5915_open(&dynamic_sensor, &sensor_bus, 0x28) != 0)
 		{
 			fprintf(stderr, "Open sensor failed !!\n");
 			return 1;
@@ -648,7 +1973,7 @@ int main (int argc, char **argv) {
 		
 		// open sensor for battery voltage
 		/// @todo remove hardcoded i2c address for voltage sensor
-		if (ads1110_open(&voltage_sensor, 0x48) != 0)
+		if (ads1110_open(&voltage_sensor, &sensor_bus, 0x48) != 0)
 		{
 			fprintf(stderr, "Open sensor failed !!\n");
 		}
@@ -662,7 +1987,7 @@ int main (int argc, char **argv) {
 			ads1110_init(&voltage_sensor);
 			
 		// Initialise MPU
-		if (mpu9150_init(I2C_BUS, MPU_SAMPLE_RATE, YAW_MIX_FACTOR, mpu_sensor.rotation))
+		if (mpu9150_init(I2C_BUS, mpu_sensor.fusion, mpu_sensor.sample_rate, mpu_sensor.yaw_time_constant, mpu_sensor.rotation))
 		{
 			fprintf(stderr, "Failed to open MPU9150\n");
 		}
@@ -673,8 +1998,16 @@ int main (int argc, char **argv) {
 			usleep(10000);
 			mpu9150_set_mag_cal(&mpu_sensor.mag_cal);
 			usleep(10000);	
+			mpu9150_set_burst_read(mpu_sensor.fifo_burst);
+			mpu_initialised = 1;
 			memset(&mpu, 0, sizeof(mpudata_t));
-			gettimeofday(&imu_last_sample, NULL);
+		}
+		
+		// the baro-inertial vario needs vertical accel in m/s^2
+		if (config.vario_imu && (!mpu_initialised || !mpu9150_accel_scale_valid()))
+		{
+			fprintf(stderr, "No usable accel scale, IMU vario disabled\n");
+			config.vario_imu = 0;
 		}
 		
 		// poll sensors for offset compensation
@@ -703,87 +2036,229 @@ int main (int argc, char **argv) {
 	
 	for(i=0; i < 1000; i++)
 		KalmanFiler1d_update(&vkf, p_static/100, 0.25, 1);
-			
-	while(1)
+	
+	// initial values for output
+	vario_state.p_static = p_static;
+	vario_state.tep_valid = tep_sensor.valid;
+	tep_valid = tep_sensor.valid;
+	memset(&mpu_fused, 0, sizeof(mpudata_t));
+	
+	// lock memory before the pipeline is allocated, so its buffers are
+	// faulted in now and not in the middle of a measurement
+	rt_init(&rt);
+	if (config.rt_enable)
+		rt_lock_memory(&rt);
+	
+	// setup pipeline between threads
+	if ((spsc_ring_init(&pressure_ring, "pressure", sizeof(t_pressure_sample), RING_SIZE) != 0) ||
+		(spsc_ring_init(&imu_ring, "imu", sizeof(t_imu_sample), RING_SIZE) != 0) ||
+		(spsc_ring_init(&vario_ring, "vario", sizeof(t_vario_sample), RING_SIZE) != 0) ||
+		(spsc_ring_init(&ahrs_ring, "ahrs", sizeof(t_ahrs_sample), RING_SIZE) != 0))
+		return 1;
+	
+	// latest values for consumers on the same board
+	// socket files are not open yet, remove_shared_objects skips them
+	ov_uds.fd = -1;
+	ahrs_uds.fd = -1;
+	if ((config.snapshot_enable && snapshot_create(&snapshot, config.snapshot_name) != 0) ||
+		(config.samples_enable && sample_ring_create(&sample_ring, config.samples_name, config.samples_slots) != 0))
 	{
-		// reset sock_err variable
-		sock_err = 0;
-		
-		// Open Socket for TCP/IP communication
-		sock = socket(AF_INET, SOCK_STREAM, 0);
-		if (sock == -1)
-			fprintf(stderr, "could not create socket\n");
-
-		server.sin_addr.s_addr = inet_addr("127.0.0.1");
-		server.sin_family = AF_INET;
-		server.sin_port = htons(OV_PORT);
-
-
-		// Open Separate Socket for LevilAHRS driver
-		sock_imu = socket(AF_INET, SOCK_STREAM, 0);
-		if (sock_imu == -1)
-			fprintf(stderr, "could not create IMU socket\n");
-
-		server_imu.sin_addr.s_addr = inet_addr("127.0.0.1");
-		server_imu.sin_family = AF_INET;
-		server_imu.sin_port = htons(AHRS_PORT);
-  
-		// try to connect to XCSoar
-		while (connect(sock, (struct sockaddr *)&server, sizeof(server)) < 0) 
+		remove_shared_objects();
+		return 1;
+	}
+	
+	// setup event loops
+	if ((reactor_init(&reactor) != 0) || (reactor_init(&fusion_reactor) != 0) || (reactor_init(&output_reactor) != 0))
+	{
+		remove_shared_objects();
+		return 1;
+	}
+	
+	// acquisition: timers with absolute deadlines for measurement
+	reactor_add_timer(&reactor, &tick_event, "tick", NSEC_PER_SEC/schedule.config.tick_rate, NSEC_PER_SEC/schedule.config.tick_rate, tick_event_handler, NULL);
+	// IMU rates, fusion runs with sample rate, output is decimated
+	sample_rate = mpu_initialised ? mpu9150_get_sample_rate() : mpu_sensor.sample_rate;
+	if (mpu_sensor.output_rate < 1 || mpu_sensor.output_rate > sample_rate)
+	{
+		fprintf(stderr, "AHRS output rate %d not in 1..%d, using %d\n", mpu_sensor.output_rate, sample_rate, sample_rate);
+		mpu_sensor.output_rate = sample_rate;
+	}
+	ahrs_decimation = sample_rate / mpu_sensor.output_rate;
+	
+	imu_poll_rate = get_imu_poll_rate(sample_rate, mpu_sensor.output_rate);
+	
+	if (mpu_sensor.int_gpio_chip[0] != '\0')
+	{
+		// wait for data ready interrupt of IMU, fall back to polling
+		if (gpio_line_open(&mpu_int_line, mpu_sensor.int_gpio_chip, mpu_sensor.int_gpio_line, mpu_sensor.int_active_low) == 0)
 		{
-			fprintf(stderr, "failed to connect (main socket), trying again\n");
-			fflush(stdout);
-			sleep(1);
+			if (mpu_initialised && mpu9150_set_int_mode(1, mpu_sensor.int_active_low) != 0)
+				gpio_line_close(&mpu_int_line);
+			else
+				imu_int_mode = 1;
 		}
 		
+		if (!imu_int_mode)
+			fprintf(stderr, "IMU interrupt not available, polling IMU\n");
+	}
+	
+	if (imu_int_mode)
+	{
+		reactor_add_fd(&reactor, &imu_int_event, "imu-int", mpu_int_line.fd, imu_int_event_handler, NULL);
+		reactor_add_timer(&reactor, &imu_event, "imu-wdog", IMU_WATCHDOG_PERIODS*NSEC_PER_SEC/imu_poll_rate, IMU_WATCHDOG_PERIODS*NSEC_PER_SEC/imu_poll_rate, imu_event_handler, NULL);
+	}
+	else
+		reactor_add_timer(&reactor, &imu_event, "imu", NSEC_PER_SEC/imu_poll_rate, NSEC_PER_SEC/imu_poll_rate, imu_event_handler, NULL);
+	
+	overload_init(&overload, OVERLOAD_MISS_THRESHOLD);
+	reactor_add_timer(&reactor, &overload_event, "overload", OVERLOAD_WINDOW_NS, OVERLOAD_WINDOW_NS, overload_event_handler, NULL);
+	
+	if (g_debug > 0)
+		reactor_add_timer(&reactor, &stats_event, "stats", (long long)STATS_INTERVAL*NSEC_PER_SEC, (long long)STATS_INTERVAL*NSEC_PER_SEC, stats_event_handler, NULL);
+	
+	// fusion: woken up by acquisition
+	reactor_add_fd(&fusion_reactor, &pressure_ring_event, "pressure", pressure_ring.efd, pressure_ring_event_handler, NULL);
+	reactor_add_fd(&fusion_reactor, &imu_ring_event, "imu", imu_ring.efd, imu_ring_event_handler, NULL);
+	
+	// output: NMEA timer and fusion results
+	if (schedule.output_rate > 0)
+		reactor_add_timer(&output_reactor, &nmea_event, "nmea", NSEC_PER_SEC/schedule.output_rate, NSEC_PER_SEC/schedule.output_rate, nmea_event_handler, NULL);
+	reactor_add_fd(&output_reactor, &vario_ring_event, "vario", vario_ring.efd, vario_ring_event_handler, NULL);
+	reactor_add_fd(&output_reactor, &ahrs_ring_event, "ahrs", ahrs_ring.efd, ahrs_ring_event_handler, NULL);
+	conn_init(&xcsoar_conn, "xcsoar", "127.0.0.1", OV_PORT);
+	conn_init(&ahrs_conn, "ahrs", "127.0.0.1", AHRS_PORT);
+	if (config.output_server)
+	{
+		// consumers connect to us
+		if ((server_open(&ov_server, "ov", config.server_address, OV_PORT, &output_reactor) != 0) ||
+			(server_open(&ahrs_server, "ahrs", config.server_address, AHRS_PORT, &output_reactor) != 0))
+		{
+			remove_shared_objects();
+			return 1;
+		}
 		
-				
-		// socket connected
-		// main data acquisition loop
-		while(sock_err >= 0)
-		{	
-			int result;
-		
-			result = usleep(12500);
-			if (result != 0)
-			{
-				printf("usleep error\n");
-				usleep(12500);
-			}
-			pressure_measurement_handler();
-			sock_err = NMEA_message_handler(sock);
-			
-			if(!sock_imu_connected) 
-			{
-				if (connect(sock_imu, (struct sockaddr *)&server_imu, sizeof(server_imu)) >= 0) 
-					sock_imu_connected = 1;
-				else
-				{
-					fprintf(stderr, "failed to connect (IMU socket)\n");
-					fflush(stdout);
-				}
-			}
-			if(sock_imu_connected)
-			{
-				// compare timer
-				gettimeofday(&curr_time, NULL);
-				if((curr_time.tv_usec - imu_last_sample.tv_usec) >= (1e6/AHRS_SAMPLE_RATE_HZ))
-				{
-					imu_last_sample = curr_time;
-					if (mpu9150_read(&mpu) == 0)
-						AHRS_message(&mpu, &mpu_sensor, sock_imu);
-				}
-			}
-		
-		} 
+		reactor_add_fd(&output_reactor, &ov_accept_event, "ov-accept", ov_server.fd, accept_event_handler, &ov_server);
+		reactor_add_fd(&output_reactor, &ahrs_accept_event, "ahrs-accept", ahrs_server.fd, accept_event_handler, &ahrs_server);
+	}
+	ov_udp.fd = -1;
+	ahrs_udp.fd = -1;
+	if (config.udp_enable)
+	{
+		if ((udp_sink_open(&ov_udp, "ov", config.udp_address, config.udp_ov_port, config.udp_ttl, config.udp_interface) != 0) ||
+			(udp_sink_open(&ahrs_udp, "ahrs", config.udp_address, config.udp_ahrs_port, config.udp_ttl, config.udp_interface) != 0))
+		{
+			remove_shared_objects();
+			return 1;
+		}
+	}
+	if (config.uds_enable)
+	{
+		if ((uds_server_open(&ov_uds, "ov", config.uds_ov_path, config.uds_allow_uid, &output_reactor) != 0) ||
+			(uds_server_open(&ahrs_uds, "ahrs", config.uds_ahrs_path, config.uds_allow_uid, &output_reactor) != 0))
+		{
+			remove_shared_objects();
+			return 1;
+		}
 		
-		// connection dropped
-		close(sock);
-		close(sock_imu);
-	} // while(1)
+		reactor_add_fd(&output_reactor, &ov_uds_accept_event, "ov-uds", ov_uds.fd, uds_accept_event_handler, &ov_uds);
+		reactor_add_fd(&output_reactor, &ahrs_uds_accept_event, "ahrs-uds", ahrs_uds.fd, uds_accept_event_handler, &ahrs_uds);
+	}
+	reactor_add_timer(&output_reactor, &conn_event, "conn", CONN_POLL_NS, 0, conn_event_handler, NULL);
+	
+	// SIGUSR1 prints runtime statistics, SIGINT and SIGTERM shut down
+	// block them before starting threads, so only the signalfd receives them
+	sigemptyset(&sigmask);
+	sigaddset(&sigmask, SIGUSR1);
+	sigaddset(&sigmask, SIGINT);
+	sigaddset(&sigmask, SIGTERM);
+	sigprocmask(SIG_BLOCK, &sigmask, NULL);
+	signal_fd = signalfd(-1, &sigmask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (signal_fd < 0)
+	{
+		// fall back to the default actions
+		fprintf(stderr, "could not create signalfd\n");
+		sigprocmask(SIG_UNBLOCK, &sigmask, NULL);
+	}
+	else
+		reactor_add_fd(&reactor, &signal_event, "signal", signal_fd, signal_event_handler, NULL);
+	
+	// from now on only the worker thread accesses the I2C bus
+	if ((i2c_queue_init(&i2c_queue) != 0) ||
+		(i2c_queue_add_device(&i2c_queue, &pressure_device, "pressure") != 0) ||
+		(i2c_queue_add_device(&i2c_queue, &imu_device, "mpu9150") != 0) ||
+		(i2c_queue_start(&i2c_queue) != 0))
+	{
+		remove_shared_objects();
+		return 1;
+	}
+	
+	// start fusion and output thread
+	if (pthread_create(&fusion_tid, NULL, fusion_thread, NULL) != 0)
+	{
+		fprintf(stderr, "could not start fusion thread\n");
+		i2c_queue_stop(&i2c_queue);
+		remove_shared_objects();
+		return 1;
+	}
+	
+	if (pthread_create(&output_tid, NULL, output_thread, NULL) != 0)
+	{
+		fprintf(stderr, "could not start output thread\n");
+		i2c_queue_stop(&i2c_queue);
+		reactor_stop(&fusion_reactor);
+		pthread_join(fusion_tid, NULL);
+		remove_shared_objects();
+		return 1;
+	}
+	
+	setup_realtime();
+	
+	// main data acquisition loop, runs until SIGINT or SIGTERM
+	reactor_run(&reactor);
+	
+	stop_threads();
+	release_resources();
+	
 	return 0;
 }
 
+/**
+* @brief Apply scheduling policy and CPU affinity to all threads
+* @return
+*
+* The I2C worker gets a priority above acquisition, as every measurement
+* waits for it. Fusion and output keep normal scheduling and are only
+* pinned. Settings which could not be applied are reported, sensord
+* continues without them.
+* @date 17.10.2026 born
+*
+*/
+void setup_realtime(void)
+{
+	int priority = 0;
+	
+	if (config.rt_enable)
+	{
+		priority = config.rt_priority;
+		if (priority < 1 || priority > 98)
+		{
+			fprintf(stderr, "Real-time priority %d not in 1..98, using %d\n", priority, RT_PRIORITY);
+			priority = RT_PRIORITY;
+		}
+	}
+	
+	rt_setup_thread(&rt, i2c_queue.tid, "i2c", priority ? priority + 1 : 0, config.cpu_i2c);
+	rt_setup_thread(&rt, pthread_self(), "acquisition", priority, config.cpu_acquisition);
+	rt_setup_thread(&rt, fusion_tid, "fusion", 0, config.cpu_fusion);
+	rt_setup_thread(&rt, output_tid, "output", 0, config.cpu_output);
+	
+	if (config.rt_enable || rt.num_checks > 0)
+		rt_print_report(&rt, fp_console);
+	
+	if (rt_failed(&rt) > 0)
+		syslog(LOG_WARNING, "%d real-time settings could not be applied", rt_failed(&rt));
+}
+
 void print_runtime_config(void)
 {
 	int i;
@@ -794,6 +2269,9 @@ void print_runtime_config(void)
 	fprintf(fp_console,"----------------------\n");
 	fprintf(fp_console,"Vario:\n");
 	fprintf(fp_console,"  Kalman Accel:\t%f\n",config.vario_x_accel);
+	fprintf(fp_console,"  IMU fusion: \t%d\n", config.vario_imu);
+	fprintf(fp_console,"  Accel var: \t%f\n", config.vario_accel_var);
+	fprintf(fp_console,"  Pressure var: \t%f\n", config.vario_baro_var);
 	fprintf(fp_console,"Sensor TEK:\n");
 	fprintf(fp_console,"  Offset: \t%f\n",tep_sensor.offset);
 	fprintf(fp_console,"  Linearity: \t%f\n", tep_sensor.linearity);
@@ -803,6 +2281,12 @@ void print_runtime_config(void)
 	fprintf(fp_console,"Sensor TOTAL:\n");
 	fprintf(fp_console,"  Offset: \t%f\n",dynamic_sensor.offset);
 	fprintf(fp_console,"  Linearity: \t%f\n", dynamic_sensor.linearity);
+	schedule_print_report(&schedule, fp_console);
+	fprintf(fp_console,"AHRS:\n");
+	fprintf(fp_console,"  Fusion: \t%s\n", mpu9150_fusion_name(mpu_sensor.fusion));
+	fprintf(fp_console,"  Sample rate: \t%d Hz\n", mpu_sensor.sample_rate);
+	fprintf(fp_console,"  Output rate: \t%d Hz\n", mpu_sensor.output_rate);
+	fprintf(fp_console,"  Yaw mix: \t%f s\n", mpu_sensor.yaw_time_constant);
 	fprintf(fp_console,"Accelerometer:\n");
 	for(i=0;i<3;i++) 
 	{
@@ -820,5 +2304,75 @@ void print_runtime_config(void)
 	fprintf(fp_console,"=========================================================================\n");
 	
 }
+
+void print_runtime_stats(void)
+{
+	fprintf(fp_console,"=========================================================================\n");
+	fprintf(fp_console,"Runtime Statistics:\n");
+	fprintf(fp_console,"-------------------\n");
+	fprintf(fp_console,"Acquisition (nominal tick %.1fms):\n", 1000.0/schedule.config.tick_rate);
+	reactor_print_stats(&reactor, fp_console);
+	fprintf(fp_console,"  real-time %s worst tick latency: %lldus\n",
+		(config.rt_enable && rt_failed(&rt) == 0) ? "on" : (config.rt_enable ? "partial" : "off"),
+		tick_event.stats.lateness_max_ns / 1000);
+	fprintf(fp_console,"Overload:\n");
+	overload_print_stats(&overload, fp_console);
+	fprintf(fp_console,"Output:\n");
+	reactor_print_stats(&output_reactor, fp_console);
+	print_age_stats("vario", &vario_age_stats);
+	print_age_stats("ahrs", &ahrs_age_stats);
+	if (config.output_server)
+	{
+		server_print_stats(&ov_server, fp_console);
+		server_print_stats(&ahrs_server, fp_console);
+	}
+	else
+	{
+		conn_print_stats(&xcsoar_conn, fp_console);
+		conn_print_stats(&ahrs_conn, fp_console);
+	}
+	if (config.udp_enable)
+	{
+		udp_sink_print_stats(&ov_udp, fp_console);
+		udp_sink_print_stats(&ahrs_udp, fp_console);
+	}
+	if (config.uds_enable)
+	{
+		uds_server_print_stats(&ov_uds, fp_console);
+		uds_server_print_stats(&ahrs_uds, fp_console);
+	}
+	fprintf(fp_console,"I2C:\n");
+	i2c_bus_print_stats(&sensor_bus, fp_console);
+	i2c_queue_print_stats(&i2c_queue, fp_console);
+	print_bus_stats("pressure", &pressure_bus_stats);
+	print_bus_stats("imu", &imu_bus_stats);
+	fprintf(fp_console,"Temperature:\n");
+	fprintf(fp_console,"  refresh  count: %lu interval: %lldms drift: %.3f Pa/s\n",
+		temp_refresh.refreshes,
+		temp_refresh.interval_ns / 1000000,
+		temp_refresh.drift);
+	fprintf(fp_console,"IMU:\n");
+	mpu9150_print_stats(fp_console);
+	if (imu_int_mode)
+	{
+		gpio_line_print_stats(&mpu_int_line, "int", fp_console);
+		fprintf(fp_console,"  watchdog reads: %lu\n", imu_watchdog_reads);
+	}
+	fprintf(fp_console,"Vario:\n");
+	fprintf(fp_console,"  filter   %s fallbacks: %lu accel bias: %.3f m/s^2\n",
+		vbf_active ? "baro-inertial" : "pressure only",
+		vbf_fallbacks,
+		vbf_active ? vbf.x_bias_ * ComputeVario(vbf.x_abs_, 1.0) : 0.0);
+	fprintf(fp_console,"Pipeline:\n");
+	spsc_ring_print_stats(&pressure_ring, fp_console);
+	spsc_ring_print_stats(&imu_ring, fp_console);
+	spsc_ring_print_stats(&vario_ring, fp_console);
+	spsc_ring_print_stats(&ahrs_ring, fp_console);
+	if (config.snapshot_enable)
+		snapshot_print_stats(&snapshot, fp_console);
+	if (config.samples_enable)
+		sample_ring_print_stats(&sample_ring, fp_console);
+	fprintf(fp_console,"=========================================================================\n");
+}
  
 
@@ -17,10 +17,60 @@
     along with this program; if not, see <http://www.gnu.org/licenses/>.	
 */
 
+#include <time.h>
+
 typedef struct 
 { 	
 	char sensordata_to_file;
 	char sensordata_from_file;
+	char benchmark;
 } t_io_mode;
 
+// bus time statistics of pressure measurement ticks or IMU updates
+typedef struct
+{
+	unsigned long ticks;			// ticks with bus access
+	unsigned long transfers;
+	unsigned long fallbacks;		// batched reads repeated one by one
+	long long busy_ns;
+	long long busy_max_ns;
+} t_tick_bus_stats;
+
+// age of samples at output, measured from end of I2C read
+typedef struct
+{
+	unsigned long count;
+	long long sum_ns;
+	long long max_ns;
+} t_age_stats;
+
+// adaptive refresh of MS5611 temperature, runs in I2C worker thread
+typedef struct
+{
+	long long interval_ns;			// current refresh interval
+	long long min_ns;
+	long long max_ns;
+	float max_error;				// Pa, tolerated error of pressure by stale temperature
+	float drift;					// Pa/s, pressure error growth by temperature drift
+	struct timespec last;			// start of last refresh
+	struct timespec ref_ts;			// reference reading for drift
+	int ref_dT[2];					// static, TEK
+	int ref_valid;
+	unsigned long refreshes;
+} t_temp_refresh;
+
+// transactions of pressure measurement cycle
+enum {
+	MS5611_PAIR_START_PRESSURE,		// both MS5611
+	MS5611_PAIR_START_TEMP,
+	MS5611_PAIR_READ_TEMP,
+	PRESSURE_READ_ALL				// both MS5611, AMS5915 and ADS1110
+};
+
+void conversion_start_done(void *, int, const struct timespec *);
+void setup_realtime(void);
+void stop_threads(void);
+void remove_shared_objects(void);
+void release_resources(void);
 void print_runtime_config(void);
+void print_runtime_stats(void);
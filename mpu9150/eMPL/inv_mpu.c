@@ -107,6 +107,14 @@ static inline int reg_int_cb(struct int_param_s *int_param)
 #error  Gyro driver is missing the system layer implementations.
 #endif
 
+/* Platforms without long reads can burst at most 255 bytes. */
+#if defined i2c_read_burst
+#define MAX_BURST_LENGTH    (1024)
+#else
+#define i2c_read_burst      i2c_read
+#define MAX_BURST_LENGTH    (255)
+#endif
+
 #if !defined MPU6050 && !defined MPU9150 && !defined MPU6500 && !defined MPU9250
 #error  Which gyro are you using? Define MPUxxxx in your compiler options.
 #endif
@@ -1745,6 +1753,59 @@ int mpu_read_fifo_stream(unsigned short length, unsigned char *data,
     return 0;
 }
 
+/**
+ *  @brief      Get all complete packets from the FIFO in one burst.
+ *  Unlike mpu_read_fifo_stream, the FIFO count is read only once and then
+ *  all complete packets (up to @e max_packets) are read with one
+ *  transaction. An empty FIFO is not an error, @e packets is zero then.
+ *  Works for DMP packets and for raw sensor packets without DMP.
+ *  @param[in]  length      Length of one packet.
+ *  @param[in]  max_packets Number of packets fitting into @e data.
+ *  @param[out] data        FIFO data.
+ *  @param[out] packets     Number of packets read.
+ *  @return     0 if successful, -2 if the FIFO overflowed and was reset.
+ */
+int mpu_read_fifo_burst(unsigned short length, unsigned short max_packets,
+    unsigned char *data, unsigned short *packets)
+{
+    unsigned char tmp[2];
+    unsigned short fifo_count, count;
+
+    packets[0] = 0;
+    if (!st.chip_cfg.dmp_on && !st.chip_cfg.fifo_enable)
+        return -1;
+    if (!st.chip_cfg.sensors)
+        return -1;
+    if (!length)
+        return -1;
+
+    if (i2c_read(st.hw->addr, st.reg->fifo_count_h, 2, tmp))
+        return -1;
+    fifo_count = (tmp[0] << 8) | tmp[1];
+    if (fifo_count > (st.hw->max_fifo >> 1)) {
+        /* FIFO is 50% full, better check overflow bit. */
+        if (i2c_read(st.hw->addr, st.reg->int_status, 1, tmp))
+            return -1;
+        if (tmp[0] & BIT_FIFO_OVERFLOW) {
+            mpu_reset_fifo();
+            return -2;
+        }
+    }
+
+    count = fifo_count / length;
+    if (count > max_packets)
+        count = max_packets;
+    if (count > MAX_BURST_LENGTH / length)
+        count = MAX_BURST_LENGTH / length;
+    if (!count)
+        return 0;
+
+    if (i2c_read_burst(st.hw->addr, st.reg->fifo_r_w, count * length, data))
+        return -1;
+    packets[0] = count;
+    return 0;
+}
+
 /**
  *  @brief      Set device to bypass mode.
  *  @param[in]  bypass_on   1 to enable bypass mode.
@@ -1806,6 +1867,18 @@ int mpu_set_int_level(unsigned char active_low)
     return 0;
 }
 
+/**
+ *  @brief      Enable or disable the interrupt pin.
+ *  With the DMP on, the interrupt fires for every packet written to the
+ *  FIFO, else for every new sample.
+ *  @param[in]  enable  1 to enable, 0 to disable.
+ *  @return     0 if successful.
+ */
+int mpu_set_int_enable(unsigned char enable)
+{
+    return set_int_enable(enable);
+}
+
 /**
  *  @brief      Enable latched interrupts.
  *  Any MPU register will clear the interrupt.
@@ -69,6 +69,7 @@ int mpu_lp_motion_interrupt(unsigned short thresh, unsigned char time,
     unsigned char lpa_freq);
 int mpu_set_int_level(unsigned char active_low);
 int mpu_set_int_latched(unsigned char enable);
+int mpu_set_int_enable(unsigned char enable);
 
 int mpu_set_dmp_state(unsigned char enable);
 int mpu_get_dmp_state(unsigned char *enabled);
@@ -111,6 +112,8 @@ int mpu_read_fifo(short *gyro, short *accel, unsigned long *timestamp,
     unsigned char *sensors, unsigned char *more);
 int mpu_read_fifo_stream(unsigned short length, unsigned char *data,
     unsigned char *more);
+int mpu_read_fifo_burst(unsigned short length, unsigned short max_packets,
+    unsigned char *data, unsigned short *packets);
 int mpu_reset_fifo(void);
 
 int mpu_write_mem(unsigned short mem_addr, unsigned short length,
@@ -1254,13 +1254,13 @@ int dmp_set_interrupt_mode(unsigned char mode)
  *  @param[out] timestamp   Timestamp in milliseconds.
  *  @param[out] sensors     Mask of sensors read from FIFO.
  *  @param[out] more        Number of remaining packets.
- *  @return     0 if successful.
+ *  @return     0 if successful, -2 if the FIFO overflowed and was reset.
  */
 int dmp_read_fifo(short *gyro, short *accel, long *quat,
     unsigned long *timestamp, short *sensors, unsigned char *more)
 {
     unsigned char fifo_data[MAX_PACKET_LENGTH];
-    unsigned char ii = 0;
+    int result;
 
     /* TODO: sensors[0] only changes when dmp_enable_feature is called. We can
      * cache this value and save some cycles.
@@ -1268,9 +1268,57 @@ int dmp_read_fifo(short *gyro, short *accel, long *quat,
     sensors[0] = 0;
 
     /* Get a packet. */
-    if (mpu_read_fifo_stream(dmp.packet_length, fifo_data, more))
+    result = mpu_read_fifo_stream(dmp.packet_length, fifo_data, more);
+    if (result)
+        return (result == -2) ? -2 : -1;
+
+    if (dmp_parse_packet(fifo_data, gyro, accel, quat, sensors))
         return -1;
 
+    get_ms(timestamp);
+    return 0;
+}
+
+/**
+ *  @brief      Get all complete packets from the FIFO in one burst.
+ *  Parse the packets with dmp_parse_packet, each one is
+ *  dmp_get_packet_length() bytes long.
+ *  @param[out] data        FIFO data.
+ *  @param[in]  max_packets Number of packets fitting into @e data.
+ *  @param[out] packets     Number of packets read.
+ *  @return     0 if successful, -2 if the FIFO overflowed and was reset.
+ */
+int dmp_read_fifo_burst(unsigned char *data, unsigned short max_packets,
+    unsigned short *packets)
+{
+    return mpu_read_fifo_burst(dmp.packet_length, max_packets, data, packets);
+}
+
+/**
+ *  @brief      Get length of one DMP packet.
+ *  @return     Packet length in bytes.
+ */
+unsigned short dmp_get_packet_length(void)
+{
+    return dmp.packet_length;
+}
+
+/**
+ *  @brief      Parse one packet read from the FIFO.
+ *  @param[in]  fifo_data   Packet data.
+ *  @param[out] gyro        Gyro data in hardware units.
+ *  @param[out] accel       Accel data in hardware units.
+ *  @param[out] quat        3-axis quaternion data in hardware units.
+ *  @param[out] sensors     Mask of sensors in packet.
+ *  @return     0 if successful.
+ */
+int dmp_parse_packet(const unsigned char *fifo_data, short *gyro, short *accel,
+    long *quat, short *sensors)
+{
+    unsigned char ii = 0;
+
+    sensors[0] = 0;
+
     /* Parse DMP packet. */
     if (dmp.feature_mask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT)) {
 #ifdef FIFO_CORRUPTION_CHECK
@@ -1331,9 +1379,8 @@ int dmp_read_fifo(short *gyro, short *accel, long *quat,
      * the gesture callbacks (if registered).
      */
     if (dmp.feature_mask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT))
-        decode_gesture(fifo_data + ii);
+        decode_gesture((unsigned char *)fifo_data + ii);
 
-    get_ms(timestamp);
     return 0;
 }
 
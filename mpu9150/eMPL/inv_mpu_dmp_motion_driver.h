@@ -92,6 +92,11 @@ int dmp_enable_gyro_cal(unsigned char enable);
  */
 int dmp_read_fifo(short *gyro, short *accel, long *quat,
     unsigned long *timestamp, short *sensors, unsigned char *more);
+int dmp_read_fifo_burst(unsigned char *data, unsigned short max_packets,
+    unsigned short *packets);
+unsigned short dmp_get_packet_length(void);
+int dmp_parse_packet(const unsigned char *fifo_data, short *gyro, short *accel,
+    long *quat, short *sensors);
 
 #endif  /* #ifndef _INV_MPU_DMP_MOTION_DRIVER_H_ */
 
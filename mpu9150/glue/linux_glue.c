@@ -27,19 +27,17 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdint.h>
-#include <sys/ioctl.h>
 #include <sys/types.h>
-#include <fcntl.h>
-#include <linux/i2c-dev.h>
 #include "linux_glue.h"
 
 #define MAX_WRITE_LEN 511
 
 // default is the RPi
-int i2c_bus = 1;
+int glue_bus_nr = 1;
 
-int i2c_fd;
-int current_slave;
+// bus used by the eMPL driver, either shared with sensord or our own
+t_i2c_bus *glue_bus;
+t_i2c_bus own_bus;
 unsigned char txBuff[MAX_WRITE_LEN + 1];
 
 
@@ -47,22 +45,17 @@ void __no_operation(void) { }
 
 int i2c_open()
 {
-	char buff[32];
-
-	if (!i2c_fd) {
-		sprintf(buff, "/dev/i2c-%d", i2c_bus);
-
+	if (!glue_bus) {
 #ifdef I2C_DEBUG
-		printf("\t\t\ti2c_open() : %s\n", buff);
+		printf("\t\t\ti2c_open() : /dev/i2c-%d\n", glue_bus_nr);
 #endif
 
-		i2c_fd = open(buff, O_RDWR);
-
-		if (i2c_fd < 0) {
+		if (i2c_bus_open(&own_bus, glue_bus_nr)) {
 			perror("open(i2c_bus)");
-			i2c_fd = 0;
 			return -1;
 		}
+
+		glue_bus = &own_bus;
 	}
 
 	return 0;
@@ -70,47 +63,35 @@ int i2c_open()
 
 void i2c_close()
 {
-	if (i2c_fd) {
-		close(i2c_fd);
-		i2c_fd = 0;
-		current_slave = 0;
+	if (glue_bus == &own_bus) {
+		i2c_bus_close(&own_bus);
+		glue_bus = NULL;
 	}
 }
 
-int i2c_select_slave(unsigned char slave_addr)
+void linux_set_i2c_bus(int bus)
 {
-	if (current_slave == slave_addr)
-		return 0;
-
-	if (i2c_open())
-		return -1;
-
-#ifdef I2C_DEBUG
-	printf("\t\ti2c_select_slave(%02X)\n", slave_addr);
-#endif
-
-	if (ioctl(i2c_fd, I2C_SLAVE, slave_addr) < 0) {
-		perror("ioctl(I2C_SLAVE)");
-		return -1;
-	}
+	// a shared bus set by linux_set_i2c_bus_handle() takes precedence
+	if (glue_bus && glue_bus != &own_bus)
+		return;
 
-	current_slave = slave_addr;
+	if (glue_bus)
+		i2c_close();
 
-	return 0;
+	glue_bus_nr = bus;
 }
 
-void linux_set_i2c_bus(int bus)
+void linux_set_i2c_bus_handle(t_i2c_bus *bus)
 {
-	if (i2c_fd)
-		i2c_close();
+	i2c_close();
 
-	i2c_bus = bus;
+	glue_bus = bus;
 }
 
 int linux_i2c_write(unsigned char slave_addr, unsigned char reg_addr,
        unsigned char length, unsigned char const *data)
 {
-	int result, i;
+	int i;
 
 	if (length > MAX_WRITE_LEN) {
 		printf("Max write length exceeded in linux_i2c_write()\n");
@@ -131,37 +112,17 @@ int linux_i2c_write(unsigned char slave_addr, unsigned char reg_addr,
 	}
 #endif
 
-	if (i2c_select_slave(slave_addr))
+	if (i2c_open())
 		return -1;
 
-	if (length == 0) {
-		result = write(i2c_fd, &reg_addr, 1);
-
-		if (result < 0) {
-			perror("write:1");
-			return result;
-		}
-		else if (result != 1) {
-			printf("Write fail:1 Tried 1 Wrote 0\n");
-			return -1;
-		}
-	}
-	else {
-		txBuff[0] = reg_addr;
-
-		for (i = 0; i < length; i++)
-			txBuff[i+1] = data[i];
+	txBuff[0] = reg_addr;
 
-		result = write(i2c_fd, txBuff, length + 1);
+	for (i = 0; i < length; i++)
+		txBuff[i+1] = data[i];
 
-		if (result < 0) {
-			perror("write:2");
-			return result;
-		}
-		else if (result < (int)length) {
-			printf("Write fail:2 Tried %u Wrote %d\n", length, result); 
-			return -1;
-		}
+	if (i2c_bus_write(glue_bus, slave_addr, txBuff, length + 1)) {
+		printf("Write fail: Tried %u\n", length + 1); 
+		return -1;
 	}
 
 	return 0;
@@ -170,44 +131,23 @@ int linux_i2c_write(unsigned char slave_addr, unsigned char reg_addr,
 int linux_i2c_read(unsigned char slave_addr, unsigned char reg_addr,
        unsigned char length, unsigned char *data)
 {
-	int tries, result, total;
-
 #ifdef I2C_DEBUG
 	int i;
 
 	printf("\tlinux_i2c_read(%02X, %02X, %u, ...)\n", slave_addr, reg_addr, length);
 #endif
 
-	if (linux_i2c_write(slave_addr, reg_addr, 0, NULL))
+	if (i2c_open())
 		return -1;
 
-	total = 0;
-	tries = 0;
-
-	while (total < length && tries < 5) {
-		result = read(i2c_fd, data + total, length - total);
-
-		if (result < 0) {
-			perror("read");
-			break;
-		}
-
-		total += result;
-
-		if (total == length)
-			break;
-
-		tries++;		
-		linux_delay_ms(10);
-	}
-
-	if (total < length)
+	// register address and data in one transfer with repeated start
+	if (i2c_bus_write_read(glue_bus, slave_addr, &reg_addr, 1, data, length))
 		return -1;
 
 #ifdef I2C_DEBUG
-	printf("\tLeaving linux_i2c_read(), read %d bytes: ", total);
+	printf("\tLeaving linux_i2c_read(), read %d bytes: ", length);
 
-	for (i = 0; i < total; i++)
+	for (i = 0; i < length; i++)
 		printf("%02X ", data[i]); 
 
 	printf("\n");
@@ -216,6 +156,19 @@ int linux_i2c_read(unsigned char slave_addr, unsigned char reg_addr,
 	return 0;
 }
 
+// same as linux_i2c_read, for reads longer than 255 bytes (FIFO bursts)
+int linux_i2c_read_burst(unsigned char slave_addr, unsigned char reg_addr,
+       unsigned short length, unsigned char *data)
+{
+	if (i2c_open())
+		return -1;
+
+	if (i2c_bus_write_read(glue_bus, slave_addr, &reg_addr, 1, data, length))
+		return -1;
+
+	return 0;
+}
+
 int linux_delay_ms(unsigned long num_ms)
 {
 	struct timespec ts;
@@ -226,19 +179,21 @@ int linux_delay_ms(unsigned long num_ms)
 	return nanosleep(&ts, NULL);
 }
 
+// CLOCK_MONOTONIC, so packet timestamps compare with the sample
+// timestamps of sensord and do not jump with the wall clock
 int linux_get_ms(unsigned long *count)
 {
-	struct timeval t;
+	struct timespec t;
 
 	if (!count)
 		return -1;
 
-	if (gettimeofday(&t, NULL) < 0) {
-		perror("gettimeofday");
+	if (clock_gettime(CLOCK_MONOTONIC, &t) < 0) {
+		perror("clock_gettime");
 		return -1;
 	}
 
-	*count = (t.tv_sec * 1000) + (t.tv_usec / 1000);	
+	*count = (t.tv_sec * 1000) + (t.tv_nsec / 1000000);	
 
 	return 0;
 }
@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <math.h>
 #include "inv_mpu.h"
+#include "../../i2c_bus.h"
 
 static inline int reg_int_cb(struct int_param_s *int_param)
 {
@@ -36,6 +37,7 @@ static inline int reg_int_cb(struct int_param_s *int_param)
 
 #define i2c_write	linux_i2c_write
 #define i2c_read	linux_i2c_read
+#define i2c_read_burst	linux_i2c_read_burst
 #define delay_ms	linux_delay_ms
 #define get_ms		linux_get_ms
 #define log_i		printf
@@ -45,12 +47,16 @@ static inline int reg_int_cb(struct int_param_s *int_param)
 void __no_operation(void);
 
 void linux_set_i2c_bus(int bus);
+void linux_set_i2c_bus_handle(t_i2c_bus *bus);
 
 int linux_i2c_write(unsigned char slave_addr, unsigned char reg_addr,
        unsigned char length, unsigned char const *data);
 
 int linux_i2c_read(unsigned char slave_addr, unsigned char reg_addr,
        unsigned char length, unsigned char *data);
+
+int linux_i2c_read_burst(unsigned char slave_addr, unsigned char reg_addr,
+       unsigned short length, unsigned char *data);
  
 int linux_delay_ms(unsigned long num_ms);
 int linux_get_ms(unsigned long *count);
@@ -29,50 +29,113 @@
 #include "inv_mpu_dmp_motion_driver.h"
 #include "mpu9150.h"
 #include "../ahrs_settings.h"
+#include "../ahrs_filter.h"
 
 static int data_ready();
 static void calibrate_data(mpudata_t *mpu);
 static void tilt_compensate(quaternion_t magQ, quaternion_t unfusedQ);
-static int data_fusion(mpudata_t *mpu);
+static int data_fusion(mpudata_t *mpu, const long *quat, const short *rawAccel);
+static int filter_fusion(mpudata_t *mpu, const dmp_packet_t *packet, const float *mag);
+static float vertical_accel(const short *rawAccel, quaternion_t q);
+static void body_mag(mpudata_t *mpu, float *mag);
+static void to_body(const float *chip, float *body);
 static unsigned short inv_row_2_scale(const signed char *row);
 static unsigned short inv_orientation_matrix_to_scalar(signed char *mtx);
 
 extern int g_debug;
 
 int debug_on;
-int yaw_mixing_factor;
+float yaw_mix_alpha;
 
 int use_accel_cal;
+int use_accel_scale;		// cal ranges are 1 g readings, used for vertical accel
 t_mpu9150_cal accel_cal_data;
 
 int use_mag_cal;
 t_mpu9150_cal mag_cal_data;
 
+int fifo_rate;
+int burst_read = 1;
+int int_mode;
+t_mpu9150_fifo_stats fifo_stats;
+
+int fusion_engine;
+t_ahrs_filter ahrs_filter;
+signed char body_orientation[9];
+float gyro_sens = 16.4f;	// LSB per deg/s at 2000 deg/s full scale
+float accel_sens = 16384.0f;	// LSB per g at 2 g full scale
+
+// longest DMP packet (quaternion, accel, gyro and gesture)
+#define DMP_MAX_PACKET_LENGTH	32
+
+// raw FIFO packet, accel and gyro
+#define RAW_PACKET_LENGTH	12
+
 void mpu9150_set_debug(int on)
 {
 	debug_on = on;
 }
 
-int mpu9150_init(int i2c_bus, int sample_rate, int mix_factor, int rotation)
+// Sets up the fusion of FIFO packets without touching the chip, so the
+// fusion can also run on recorded or synthetic data.
+// yaw_time_constant is the time (s) in which the fused yaw follows the
+// tilt compensated mag yaw, 0 disables mixing. The mix per DMP packet is
+// derived from it, so the behaviour is the same at any sample rate.
+// The software filters use their own gains from ahrs_settings.h.
+int mpu9150_init_fusion(int fusion, int sample_rate, float yaw_time_constant, int rotation)
 {
-											
-	signed char gyro_orientation[9];
-																
-	set_orientation(rotation, gyro_orientation);		
-	
-	if (i2c_bus < 0 || i2c_bus > 3)
+	if (fusion == MPU9150_FUSION_DMP) {
+		if (sample_rate < 2 || sample_rate > MPU9150_MAX_SAMPLE_RATE)
+			return -1;
+
+		// DMP FIFO rate is 200 Hz divided by an integer
+		fifo_rate = MPU9150_MAX_SAMPLE_RATE / (MPU9150_MAX_SAMPLE_RATE / sample_rate);
+	}
+	else if (fusion == MPU9150_FUSION_MADGWICK || fusion == MPU9150_FUSION_MAHONY) {
+		if (sample_rate < 4 || sample_rate > MPU9150_MAX_RAW_SAMPLE_RATE)
+			return -1;
+
+		// sample rate is 1 kHz divided by an integer
+		fifo_rate = MPU9150_MAX_RAW_SAMPLE_RATE / (MPU9150_MAX_RAW_SAMPLE_RATE / sample_rate);
+	}
+	else
 		return -1;
 
-	if (sample_rate < 2 || sample_rate > 50)
+	if (yaw_time_constant < 0.0f)
 		return -1;
 
-	if (mix_factor < 0 || mix_factor > 100)
+	fusion_engine = fusion;
+
+	if (yaw_time_constant > 0.0f)
+		yaw_mix_alpha = 1.0f - expf(-1.0f / (fifo_rate * yaw_time_constant));
+	else
+		yaw_mix_alpha = 0.0f;
+
+	set_orientation(rotation, body_orientation);
+
+	if (fusion == MPU9150_FUSION_MAHONY)
+		ahrs_filter_init(&ahrs_filter, AHRS_FILTER_MAHONY, AHRS_MAHONY_KP, AHRS_MAHONY_KI);
+	else
+		ahrs_filter_init(&ahrs_filter, AHRS_FILTER_MADGWICK, AHRS_MADGWICK_BETA, AHRS_MADGWICK_ZETA);
+
+	return 0;
+}
+
+// With a software fusion engine the DMP firmware is not loaded, the FIFO
+// gets raw gyro and accel at up to the 1 kHz gyro output rate.
+int mpu9150_init(int i2c_bus, int fusion, int sample_rate, float yaw_time_constant, int rotation)
+{
+	unsigned short sens;
+
+	if (i2c_bus < 0 || i2c_bus > 3)
 		return -1;
 
-	yaw_mixing_factor = mix_factor;
+	if (mpu9150_init_fusion(fusion, sample_rate, yaw_time_constant, rotation))
+		return -1;
 
 	linux_set_i2c_bus(i2c_bus);
 
+	printf("Using orientation %d", rotation);
 	printf("\nInitializing IMU .");
 	fflush(stdout);
 
@@ -108,11 +171,27 @@ int mpu9150_init(int i2c_bus, int sample_rate, int mix_factor, int rotation)
 	printf(".");
 	fflush(stdout);
 
-	if (mpu_set_compass_sample_rate(sample_rate)) {
+	if (mpu_set_compass_sample_rate(sample_rate < MPU9150_MAX_COMPASS_RATE ? sample_rate : MPU9150_MAX_COMPASS_RATE)) {
 		printf("\nmpu_set_compass_sample_rate() failed\n");
 		return -1;
 	}
 
+	if (mpu_get_gyro_sens(&gyro_sens)) {
+		printf("\nmpu_get_gyro_sens() failed\n");
+		return -1;
+	}
+
+	if (mpu_get_accel_sens(&sens)) {
+		printf("\nmpu_get_accel_sens() failed\n");
+		return -1;
+	}
+	accel_sens = sens;
+
+	if (fusion_engine != MPU9150_FUSION_DMP) {
+		printf(" done\n\n");
+		return 0;
+	}
+
 	printf(".");
 	fflush(stdout);
 
@@ -124,7 +203,7 @@ int mpu9150_init(int i2c_bus, int sample_rate, int mix_factor, int rotation)
 	printf(".");
 	fflush(stdout);
 
-	if (dmp_set_orientation(inv_orientation_matrix_to_scalar(gyro_orientation))) {
+	if (dmp_set_orientation(inv_orientation_matrix_to_scalar(body_orientation))) {
 		printf("\ndmp_set_orientation() failed\n");
 		return -1;
 	}
@@ -162,7 +241,7 @@ int mpu9150_init(int i2c_bus, int sample_rate, int mix_factor, int rotation)
 void mpu9150_exit()
 {
 	// turn off the DMP on exit 
-	if (mpu_set_dmp_state(0))
+	if (fusion_engine == MPU9150_FUSION_DMP && mpu_set_dmp_state(0))
 		printf("mpu_set_dmp_state(0) failed\n");
 
 	// TODO: Should turn off the sensors too
@@ -175,11 +254,23 @@ void mpu9150_set_accel_cal(t_mpu9150_cal *cal)
 
 	if (!cal) {
 		use_accel_cal = 0;
+		use_accel_scale = 0;
 		return;
 	}
 
 	memcpy(&accel_cal_data, cal, sizeof(t_mpu9150_cal));
 
+	// without EEPROM data the ranges are 0, vertical accel then uses
+	// the sensitivity from the chip instead
+	use_accel_scale = 1;
+	for (i = 0; i < 3; i++) {
+		if (accel_cal_data.range[i] < accel_sens / 2 || accel_cal_data.range[i] > accel_sens * 2)
+			use_accel_scale = 0;
+	}
+
+	if (debug_on && !use_accel_scale)
+		printf("\naccel cal ranges are no 1 g readings, using %.0f LSB/g\n", accel_sens);
+
 	for (i = 0; i < 3; i++) {
 		if (accel_cal_data.range[i] < 1)
 			accel_cal_data.range[i] = 1;
@@ -201,6 +292,16 @@ void mpu9150_set_accel_cal(t_mpu9150_cal *cal)
 	use_accel_cal = 1;
 }
 
+// 1 if vertical accel is scaled sanely, from a valid accel cal or from the
+// chip sensitivity
+int mpu9150_accel_scale_valid()
+{
+	if (use_accel_cal && use_accel_scale)
+		return 1;
+
+	return (accel_sens >= 1024.0f && accel_sens <= 16384.0f);
+}
+
 void mpu9150_set_mag_cal(t_mpu9150_cal *cal)
 {
 	int i;
@@ -234,27 +335,275 @@ void mpu9150_set_mag_cal(t_mpu9150_cal *cal)
 	use_mag_cal = 1;
 }
 
-int mpu9150_read_dmp(mpudata_t *mpu)
+int mpu9150_get_sample_rate()
+{
+	return fifo_rate;
+}
+
+// Number of packets the FIFO holds with the given fusion engine
+int mpu9150_get_fifo_capacity(int fusion)
+{
+	if (fusion == MPU9150_FUSION_DMP)
+		return MPU9150_MAX_DMP_PACKETS;
+
+	return MPU9150_MAX_PACKETS;
+}
+
+// Bytes per FIFO packet with the given fusion engine (upper bound for DMP)
+int mpu9150_get_packet_length(int fusion)
+{
+	if (fusion == MPU9150_FUSION_DMP)
+		return DMP_MAX_PACKET_LENGTH;
+
+	return RAW_PACKET_LENGTH;
+}
+
+// Gyro bias (deg/s) estimated by the software filter, in body frame
+void mpu9150_get_gyro_bias(float *bias)
+{
+	int i;
+
+	for (i = 0; i < 3; i++)
+		bias[i] = ahrs_filter.gyro_bias[i] * RAD_TO_DEGREE;
+}
+
+const char *mpu9150_fusion_name(int fusion)
+{
+	switch (fusion) {
+	case MPU9150_FUSION_DMP:
+		return "dmp";
+	case MPU9150_FUSION_MADGWICK:
+		return "madgwick";
+	case MPU9150_FUSION_MAHONY:
+		return "mahony";
+	}
+
+	return "unknown";
+}
+
+void mpu9150_set_burst_read(int on)
+{
+	burst_read = on;
+}
+
+// Drives the INT pin for every DMP packet, or every sample without DMP. The caller waits for the edge
+// and reads only then, so data_ready() does not poll the int status.
+// The pin is latched until the next register read.
+int mpu9150_set_int_mode(int on, int active_low)
+{
+	if (on) {
+		if (mpu_set_int_level(active_low ? 1 : 0)) {
+			printf("mpu_set_int_level() failed\n");
+			return -1;
+		}
+
+		if (mpu_set_int_latched(1)) {
+			printf("mpu_set_int_latched() failed\n");
+			return -1;
+		}
+	}
+
+	if (mpu_set_int_enable(on ? 1 : 0)) {
+		printf("mpu_set_int_enable() failed\n");
+		return -1;
+	}
+
+	int_mode = on;
+
+	return 0;
+}
+
+// Reads FIFO count and all complete packets with two transactions.
+// The FIFO count tells if there is data, so the int status is not polled.
+static int read_dmp_burst(dmp_packet_t *packets, int max_packets)
 {
+	unsigned char fifo_data[MPU9150_MAX_DMP_PACKETS * DMP_MAX_PACKET_LENGTH];
+	unsigned short length;
+	unsigned short count;
+	unsigned long now;
 	short sensors;
-	unsigned char more;
+	int result;
+	int i;
 
-	if (!data_ready())
+	if (max_packets > MPU9150_MAX_DMP_PACKETS)
+		max_packets = MPU9150_MAX_DMP_PACKETS;
+
+	length = dmp_get_packet_length();
+	if (length == 0 || length > DMP_MAX_PACKET_LENGTH)
 		return -1;
 
-	if (dmp_read_fifo(mpu->rawGyro, mpu->rawAccel, mpu->rawQuat, &mpu->dmpTimestamp, &sensors, &more) < 0) {
-		if(g_debug > 1)printf("dmp_read_fifo() failed\n");
+	result = dmp_read_fifo_burst(fifo_data, max_packets, &count);
+
+	if (result == -2) {
+		fifo_stats.overflows++;
+		if(g_debug > 0)printf("DMP FIFO overflow\n");
 		return -1;
 	}
 
-	while (more) {
-		// Fell behind, reading again
-		if (dmp_read_fifo(mpu->rawGyro, mpu->rawAccel, mpu->rawQuat, &mpu->dmpTimestamp, &sensors, &more) < 0) {
-			if(g_debug > 1)printf("dmp_read_fifo() failed [2]\n");
+	if (result < 0) {
+		if(g_debug > 1)printf("dmp_read_fifo_burst() failed\n");
+		return -1;
+	}
+
+	if (count == 0)
+		return -1;
+
+	linux_get_ms(&now);
+
+	for (i = 0; i < count; i++) {
+		if (dmp_parse_packet(fifo_data + i * length, packets[i].rawGyro, packets[i].rawAccel,
+				packets[i].rawQuat, &sensors) < 0)
 			return -1;
+
+		packets[i].timestamp = now;
+	}
+
+	if (count - 1 > fifo_stats.maxBacklog)
+		fifo_stats.maxBacklog = count - 1;
+
+	return count;
+}
+
+// Reads raw accel and gyro packets like read_dmp_burst. There is no
+// quaternion, the software filter integrates the gyro itself.
+static int read_raw_burst(dmp_packet_t *packets, int max_packets)
+{
+	unsigned char fifo_data[MPU9150_MAX_PACKETS * RAW_PACKET_LENGTH];
+	unsigned char *p;
+	unsigned short count;
+	unsigned long now;
+	int result;
+	int i, j;
+
+	if (max_packets > MPU9150_MAX_PACKETS)
+		max_packets = MPU9150_MAX_PACKETS;
+
+	result = mpu_read_fifo_burst(RAW_PACKET_LENGTH, max_packets, fifo_data, &count);
+
+	if (result == -2) {
+		fifo_stats.overflows++;
+		if(g_debug > 0)printf("FIFO overflow\n");
+		return -1;
+	}
+
+	if (result < 0) {
+		if(g_debug > 1)printf("mpu_read_fifo_burst() failed\n");
+		return -1;
+	}
+
+	if (count == 0)
+		return -1;
+
+	linux_get_ms(&now);
+
+	for (i = 0; i < count; i++) {
+		p = fifo_data + i * RAW_PACKET_LENGTH;
+
+		// accel before gyro, in register order
+		for (j = 0; j < 3; j++) {
+			packets[i].rawAccel[j] = (short)((p[2 * j] << 8) | p[2 * j + 1]);
+			packets[i].rawGyro[j] = (short)((p[6 + 2 * j] << 8) | p[6 + 2 * j + 1]);
 		}
+
+		memset(packets[i].rawQuat, 0, sizeof(packets[i].rawQuat));
+		packets[i].timestamp = now;
 	}
 
+	if (count - 1 > fifo_stats.maxBacklog)
+		fifo_stats.maxBacklog = count - 1;
+
+	return count;
+}
+
+// Reads packet by packet, polling the int status first.
+static int read_dmp_single(dmp_packet_t *packets, int max_packets)
+{
+	short sensors;
+	unsigned char more = 1;
+	int count = 0;
+	int result;
+
+	if (!data_ready())
+		return -1;
+
+	while (more && count < max_packets) {
+		result = dmp_read_fifo(packets[count].rawGyro, packets[count].rawAccel, packets[count].rawQuat,
+				&packets[count].timestamp, &sensors, &more);
+
+		if (result == -2) {
+			// FIFO overflowed and was reset, packets already read are still valid
+			fifo_stats.overflows++;
+			if(g_debug > 0)printf("DMP FIFO overflow\n");
+			break;
+		}
+
+		if (result < 0) {
+			if(g_debug > 1)printf("dmp_read_fifo() failed\n");
+			if (count == 0)
+				return -1;
+			break;
+		}
+
+		if (count == 0 && more > fifo_stats.maxBacklog)
+			fifo_stats.maxBacklog = more;
+
+		count++;
+	}
+
+	if (count == 0)
+		return -1;
+
+	return count;
+}
+
+// Reads all pending DMP packets, oldest first, returns number of packets or -1.
+// Packets are read back to back, so their timestamps are spread backwards
+// from the last one by the FIFO rate.
+// Without DMP the packets hold raw accel and gyro, always read in a burst.
+int mpu9150_read_dmp_batch(dmp_packet_t *packets, int max_packets)
+{
+	int count;
+	int i;
+
+	if (fusion_engine != MPU9150_FUSION_DMP)
+		count = read_raw_burst(packets, max_packets);
+	else if (burst_read)
+		count = read_dmp_burst(packets, max_packets);
+	else
+		count = read_dmp_single(packets, max_packets);
+
+	if (count <= 0)
+		return -1;
+
+	for (i = 0; i < count - 1 && fifo_rate > 0; i++)
+		packets[i].timestamp = packets[count - 1].timestamp - ((count - 1 - i) * 1000) / fifo_rate;
+
+	fifo_stats.reads++;
+	fifo_stats.packets += count;
+
+	return count;
+}
+
+int mpu9150_read_dmp(mpudata_t *mpu)
+{
+	dmp_packet_t *last;
+	int count;
+
+	count = mpu9150_read_dmp_batch(mpu->packets, MPU9150_MAX_PACKETS);
+	if (count < 0) {
+		mpu->numPackets = 0;
+		return -1;
+	}
+
+	mpu->numPackets = count;
+
+	// keep latest packet for users of single values
+	last = &mpu->packets[count - 1];
+	memcpy(mpu->rawGyro, last->rawGyro, sizeof(mpu->rawGyro));
+	memcpy(mpu->rawAccel, last->rawAccel, sizeof(mpu->rawAccel));
+	memcpy(mpu->rawQuat, last->rawQuat, sizeof(mpu->rawQuat));
+	mpu->dmpTimestamp = last->timestamp;
+
 	return 0;
 }
 
@@ -268,23 +617,96 @@ int mpu9150_read_mag(mpudata_t *mpu)
 	return 0;
 }
 
-int mpu9150_read(mpudata_t *mpu)
+// Mag first, so the FIFO read is the last transfer and the completion
+// time of the read is the time of the newest packet.
+int mpu9150_read_raw(mpudata_t *mpu)
 {
-	if (mpu9150_read_dmp(mpu) != 0)
+	if (mpu9150_read_mag(mpu) != 0)
 		return -1;
 
-	if (mpu9150_read_mag(mpu) != 0)
+	if (mpu9150_read_dmp(mpu) != 0)
 		return -1;
 
+	return 0;
+}
+
+// Integrates every packet of the last read in order, so the yaw
+// mixing runs at the FIFO rate independent of the polling rate.
+// Every packet gets the vertical acceleration at its attitude.
+int mpu9150_fuse(mpudata_t *mpu)
+{
+	dmp_packet_t last;
+	float mag[3];
+	int i;
+
 	calibrate_data(mpu);
 
-	return data_fusion(mpu);
+	if (fusion_engine != MPU9150_FUSION_DMP) {
+		// mag is read once per FIFO read and used for all packets
+		body_mag(mpu, mag);
+
+		if (mpu->numPackets == 0) {
+			memcpy(last.rawGyro, mpu->rawGyro, sizeof(last.rawGyro));
+			memcpy(last.rawAccel, mpu->rawAccel, sizeof(last.rawAccel));
+			return filter_fusion(mpu, &last, mag);
+		}
+
+		for (i = 0; i < mpu->numPackets; i++) {
+			filter_fusion(mpu, &mpu->packets[i], mag);
+			mpu->packets[i].vertAccel = mpu->vertAccel;
+		}
+
+		return 0;
+	}
+
+	if (mpu->numPackets == 0)
+		return data_fusion(mpu, mpu->rawQuat, mpu->rawAccel);
+
+	for (i = 0; i < mpu->numPackets; i++) {
+		if (data_fusion(mpu, mpu->packets[i].rawQuat, mpu->packets[i].rawAccel) != 0)
+			return -1;
+		mpu->packets[i].vertAccel = mpu->vertAccel;
+	}
+
+	return 0;
+}
+
+void mpu9150_print_stats(FILE *fp)
+{
+	float bias[3];
+
+	fprintf(fp, "  fifo     reads: %lu packets: %lu (%.2f/read) max backlog: %lu overflows: %lu\n",
+		fifo_stats.reads,
+		fifo_stats.packets,
+		fifo_stats.reads ? (float)fifo_stats.packets / fifo_stats.reads : 0.0f,
+		fifo_stats.maxBacklog,
+		fifo_stats.overflows);
+
+	if (fusion_engine != MPU9150_FUSION_DMP) {
+		mpu9150_get_gyro_bias(bias);
+		fprintf(fp, "  %-8s updates: %lu gyro bias: %.3f %.3f %.3f deg/s\n",
+			mpu9150_fusion_name(fusion_engine),
+			ahrs_filter.updates,
+			bias[0], bias[1], bias[2]);
+	}
+}
+
+int mpu9150_read(mpudata_t *mpu)
+{
+	if (mpu9150_read_raw(mpu) != 0)
+		return -1;
+
+	return mpu9150_fuse(mpu);
 }
 
 int data_ready()
 {
 	short status;
 
+	// caller already saw the interrupt
+	if (int_mode)
+		return 1;
+
 	if (mpu_get_int_status(&status) < 0) {
 		printf("mpu_get_int_status() failed\n");
 		return 0;
@@ -342,7 +764,7 @@ void tilt_compensate(quaternion_t magQ, quaternion_t unfusedQ)
 	quaternionMultiply(unfusedQ, tempQ, magQ);
 }
 
-int data_fusion(mpudata_t *mpu)
+int data_fusion(mpudata_t *mpu, const long *quat, const short *rawAccel)
 {
 	quaternion_t dmpQuat;
 	vector3d_t dmpEuler;
@@ -353,14 +775,16 @@ int data_fusion(mpudata_t *mpu)
 	float newMagYaw;
 	float newYaw;
 	
-	dmpQuat[QUAT_W] = (float)mpu->rawQuat[QUAT_W];
-	dmpQuat[QUAT_X] = (float)mpu->rawQuat[QUAT_X];
-	dmpQuat[QUAT_Y] = (float)mpu->rawQuat[QUAT_Y];
-	dmpQuat[QUAT_Z] = (float)mpu->rawQuat[QUAT_Z];
+	dmpQuat[QUAT_W] = (float)quat[QUAT_W];
+	dmpQuat[QUAT_X] = (float)quat[QUAT_X];
+	dmpQuat[QUAT_Y] = (float)quat[QUAT_Y];
+	dmpQuat[QUAT_Z] = (float)quat[QUAT_Z];
 
 	quaternionNormalize(dmpQuat);	
 	quaternionToEuler(dmpQuat, dmpEuler);
 
+	mpu->vertAccel = vertical_accel(rawAccel, dmpQuat);
+
 	mpu->fusedEuler[VEC3_X] = dmpEuler[VEC3_X];
 	mpu->fusedEuler[VEC3_Y] = -dmpEuler[VEC3_Y];
 	mpu->fusedEuler[VEC3_Z] = 0;
@@ -401,8 +825,7 @@ int data_fusion(mpudata_t *mpu)
 	else if (deltaMagYaw < -(float)M_PI)
 		deltaMagYaw += TWO_PI;
 
-	if (yaw_mixing_factor > 0)
-		newYaw += deltaMagYaw / yaw_mixing_factor;
+	newYaw += deltaMagYaw * yaw_mix_alpha;
 
 	if (newYaw > TWO_PI)
 		newYaw -= TWO_PI;
@@ -421,6 +844,117 @@ int data_fusion(mpudata_t *mpu)
 	return 0;
 }
 
+// Rotates a vector in accel/gyro chip axes into the mounting frame,
+// like dmp_set_orientation does for the DMP.
+void to_body(const float *chip, float *body)
+{
+	int i;
+
+	for (i = 0; i < 3; i++)
+		body[i] = body_orientation[3 * i] * chip[0] + body_orientation[3 * i + 1] * chip[1]
+			+ body_orientation[3 * i + 2] * chip[2];
+}
+
+// AK8975 axes are X = accel Y, Y = accel X, Z = -accel Z
+void body_mag(mpudata_t *mpu, float *mag)
+{
+	float chip[3];
+	float raw[3];
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		if (use_mag_cal)
+			raw[i] = (float)(mpu->rawMag[i] - mag_cal_data.offset[i]) * MAG_SENSOR_RANGE / mag_cal_data.range[i];
+		else
+			raw[i] = mpu->rawMag[i];
+	}
+
+	chip[VEC3_X] = raw[VEC3_Y];
+	chip[VEC3_Y] = raw[VEC3_X];
+	chip[VEC3_Z] = -raw[VEC3_Z];
+
+	to_body(chip, mag);
+}
+
+// Runs the software filter on one raw packet. The filter quaternion is
+// converted with the same axis signs as the DMP quaternion in data_fusion,
+// its yaw is already referenced to the mag.
+int filter_fusion(mpudata_t *mpu, const dmp_packet_t *packet, const float *mag)
+{
+	float chip[3];
+	float gyro[3];
+	float accel[3];
+	vector3d_t euler;
+	float yaw;
+	int i;
+
+	for (i = 0; i < 3; i++)
+		chip[i] = packet->rawGyro[i] / gyro_sens * DEGREE_TO_RAD;
+	to_body(chip, gyro);
+
+	for (i = 0; i < 3; i++) {
+		if (use_accel_cal)
+			chip[i] = (float)packet->rawAccel[i] * ACCEL_SENSOR_RANGE / accel_cal_data.range[i];
+		else
+			chip[i] = packet->rawAccel[i];
+	}
+	to_body(chip, accel);
+
+	ahrs_filter_update(&ahrs_filter, gyro, accel, mag, 1.0f / fifo_rate);
+
+	mpu->vertAccel = vertical_accel(packet->rawAccel, ahrs_filter.q);
+
+	quaternionToEuler(ahrs_filter.q, euler);
+
+	yaw = -euler[VEC3_Z];
+	if (yaw > (float)M_PI)
+		yaw -= TWO_PI;
+	else if (yaw <= -(float)M_PI)
+		yaw += TWO_PI;
+
+	mpu->fusedEuler[VEC3_X] = euler[VEC3_X];
+	mpu->fusedEuler[VEC3_Y] = -euler[VEC3_Y];
+	mpu->fusedEuler[VEC3_Z] = yaw;
+	mpu->lastYaw = (yaw < 0.0f) ? yaw + TWO_PI : yaw;
+
+	eulerToQuaternion(mpu->fusedEuler, mpu->fusedQuat);
+
+	return 0;
+}
+
+// Earth frame vertical acceleration (m/s^2, up, without gravity) of a raw
+// accel sample. q is the attitude of the mounting frame, from the DMP or
+// the software filter. With a valid accel cal the range is the 1 g
+// reading, otherwise the chip sensitivity is used.
+float vertical_accel(const short *rawAccel, quaternion_t q)
+{
+	float chip[3];
+	float body[3];
+	quaternion_t accelQ;
+	quaternion_t conjugateQ;
+	quaternion_t tempQ;
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		if (use_accel_cal && use_accel_scale)
+			chip[i] = (float)rawAccel[i] / accel_cal_data.range[i];
+		else
+			chip[i] = rawAccel[i] / accel_sens;
+	}
+	to_body(chip, body);
+
+	accelQ[QUAT_W] = 0.0f;
+	accelQ[QUAT_X] = body[VEC3_X];
+	accelQ[QUAT_Y] = body[VEC3_Y];
+	accelQ[QUAT_Z] = body[VEC3_Z];
+
+	quaternionConjugate(q, conjugateQ);
+	quaternionMultiply(accelQ, conjugateQ, tempQ);
+	quaternionMultiply(q, tempQ, accelQ);
+
+	return (accelQ[QUAT_Z] - 1.0f) * GRAVITY;
+}
+
 /* These next two functions convert the orientation matrix (see
  * gyro_orientation) to a scalar representation for use by the DMP.
  * NOTE: These functions are borrowed from InvenSense's MPL.
@@ -615,8 +1149,6 @@ int set_orientation(int rotation, signed char gyro_orientation[9])
 		printf("Cannot determine orientation from system config file!");
 	*/
 	
-	printf("Using orientation %d", rotation);
-	
 	switch(rotation) 
 	{
 		case 1: 	
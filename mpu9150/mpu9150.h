@@ -24,11 +24,27 @@
 #ifndef MPU9150_H
 #define MPU9150_H
 
+#include <stdio.h>
 #include "quaternion.h"
 
 #define MAG_SENSOR_RANGE 	4096
 #define ACCEL_SENSOR_RANGE 	32000
 
+#define GRAVITY			9.80665f	// m/s^2
+
+#define MPU9150_MAX_SAMPLE_RATE		200		// DMP
+#define MPU9150_MAX_RAW_SAMPLE_RATE	1000	// gyro output rate
+#define MPU9150_MAX_COMPASS_RATE	100
+
+// 1024 byte FIFO holds 36 DMP packets of 28 byte or 85 raw packets of 12 byte
+#define MPU9150_MAX_PACKETS	85
+#define MPU9150_MAX_DMP_PACKETS	36
+
+// fusion engines
+#define MPU9150_FUSION_DMP		0	// DMP quaternion, mixed with mag yaw
+#define MPU9150_FUSION_MADGWICK	1	// software filter on raw FIFO data
+#define MPU9150_FUSION_MAHONY	2
+
 typedef struct {
 	short offset[3];
 	short range[3];
@@ -42,14 +58,41 @@ typedef struct {
 	float roll_adjust;
 	float pitch_adjust;
 	float yaw_adjust;
+	int fifo_burst;
+	int fusion;
+	int sample_rate;
+	int output_rate;
+	float yaw_time_constant;
+	char int_gpio_chip[64];
+	int int_gpio_line;
+	int int_active_low;
 } t_mpu9150;
 
+typedef struct {
+	short rawGyro[3];
+	short rawAccel[3];
+	long rawQuat[4];
+	unsigned long timestamp;
+	float vertAccel;		// earth frame, up, without gravity (m/s^2)
+} dmp_packet_t;
+
+typedef struct {
+	unsigned long reads;
+	unsigned long packets;
+	unsigned long maxBacklog;
+	unsigned long overflows;
+} t_mpu9150_fifo_stats;
+
 typedef struct {
 	short rawGyro[3];
 	short rawAccel[3];
 	long rawQuat[4];
 	unsigned long dmpTimestamp;
 
+	// all packets of last read, oldest first, last one also in raw* above
+	dmp_packet_t packets[MPU9150_MAX_PACKETS];
+	int numPackets;
+
 	short rawMag[3];
 	unsigned long magTimestamp;
 
@@ -58,6 +101,7 @@ typedef struct {
 
 	quaternion_t fusedQuat;
 	vector3d_t fusedEuler;
+	float vertAccel;		// of latest packet, earth frame, up, without gravity (m/s^2)
 
 	float lastDMPYaw;
 	float lastYaw;
@@ -65,13 +109,26 @@ typedef struct {
 
 
 void mpu9150_set_debug(int on);
-int mpu9150_init(int i2c_bus, int sample_rate, int yaw_mixing_factor, int rotation);
+int mpu9150_init(int i2c_bus, int fusion, int sample_rate, float yaw_time_constant, int rotation);
+int mpu9150_init_fusion(int fusion, int sample_rate, float yaw_time_constant, int rotation);
+int mpu9150_get_sample_rate();
+int mpu9150_get_fifo_capacity(int fusion);
+int mpu9150_get_packet_length(int fusion);
+void mpu9150_get_gyro_bias(float *bias);
+const char *mpu9150_fusion_name(int fusion);
 void mpu9150_exit();
 int mpu9150_read(mpudata_t *mpu);
+int mpu9150_read_raw(mpudata_t *mpu);
+int mpu9150_fuse(mpudata_t *mpu);
 int mpu9150_read_dmp(mpudata_t *mpu);
+int mpu9150_read_dmp_batch(dmp_packet_t *packets, int max_packets);
 int mpu9150_read_mag(mpudata_t *mpu);
 void mpu9150_set_accel_cal(t_mpu9150_cal *cal);
+int mpu9150_accel_scale_valid();
 void mpu9150_set_mag_cal(t_mpu9150_cal *cal);
+void mpu9150_print_stats(FILE *fp);
+void mpu9150_set_burst_read(int on);
+int mpu9150_set_int_mode(int on, int active_low);
 
 int set_orientation(int rotation, signed char gyro_orientation[9]);
 
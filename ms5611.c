@@ -21,50 +21,102 @@
 #include <time.h>
 #include <stdio.h>
 #include <stdint.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <math.h>
 #include <time.h>
-#include <linux/i2c-dev.h>
-#include <fcntl.h>
 #include <errno.h>
 #include <string.h>
+#include "i2c_bus.h"
 #include "def.h"
 
 extern int g_debug;
 extern FILE *fp_console;
 
+// oversampling ratios with command bits and max. conversion time (datasheet)
+static const struct {
+	int osr;
+	uint8_t cmd;
+	long conversion_ns;
+} osr_table[] = {
+	{ 256, 0x00,  600000},
+	{ 512, 0x02, 1170000},
+	{1024, 0x04, 2280000},
+	{2048, 0x06, 4540000},
+	{4096, 0x08, 9040000}
+};
+#define OSR_TABLE_SIZE (sizeof(osr_table) / sizeof(osr_table[0]))
+
+/**
+* @brief Set oversampling ratio of MS5611 conversions
+* @param sensor pointer to sensor instance
+* @param osr oversampling ratio 256, 512, 1024, 2048 or 4096
+* @return result
+*
+* Used for pressure and temperature conversions started afterwards.
+* @date 17.10.2026 born
+*
+*/
+int ms5611_set_osr(t_ms5611 *sensor, int osr)
+{
+	unsigned int i;
+
+	for (i = 0; i < OSR_TABLE_SIZE; i++)
+	{
+		if (osr_table[i].osr == osr)
+		{
+			sensor->osr = osr;
+			sensor->osr_cmd = osr_table[i].cmd;
+			return (0);
+		}
+	}
+
+	fprintf(stderr, "Invalid MS5611 oversampling ratio %d\n", osr);
+	return (1);
+}
+
+/**
+* @brief Max. conversion time for oversampling ratio
+* @param osr oversampling ratio
+* @return conversion time in ns, 0 for invalid ratio
+*
+* @date 17.10.2026 born
+*
+*/
+long ms5611_conversion_ns(int osr)
+{
+	unsigned int i;
+
+	for (i = 0; i < OSR_TABLE_SIZE; i++)
+	{
+		if (osr_table[i].osr == osr)
+			return (osr_table[i].conversion_ns);
+	}
+
+	return (0);
+}
+
 /**
 * @brief Establish connection to MS5611 pressure sensor
 * @param sensor pointer to sensor instance
+* @param bus pointer to shared I2C bus
 * @param i2c_address
 * @return result
 *
-* @date 24.03.2016 revised
+* @date 17.10.2026 revised
 *
 */ 
-int ms5611_open(t_ms5611 *sensor, unsigned char i2c_address)
+int ms5611_open(t_ms5611 *sensor, t_i2c_bus *bus, unsigned char i2c_address)
 {
-	// local variables
-	int fd;
-	
-	// try to open I2C Bus
-	fd = open("/dev/i2c-1", O_RDWR);
-	
-	if (fd < 0) {
-		fprintf(stderr, "Error opening file: %s\n", strerror(errno));
-		return 1;
-	}
-
-	if (ioctl(fd, I2C_SLAVE, i2c_address) < 0) {
-		fprintf(stderr, "ioctl error: %s\n", strerror(errno));
+	// check if I2C Bus is open
+	if (bus->fd < 0) {
+		fprintf(stderr, "I2C bus not open\n");
 		return 1;
 	}
 	
 	if (g_debug > 0) printf("Opened MS5611 on 0x%x\n", i2c_address);
 	
-	// assign file handle to sensor object
-	sensor->fd = fd;
+	// assign bus to sensor object
+	sensor->bus = bus;
 	sensor->address = i2c_address;
 	return (0);
 }
@@ -132,12 +184,7 @@ int ms5611_init(t_ms5611 *sensor)
 	{
 		// get calibration values
 		buf[0] = a;													// This is the register we want to read from
-		if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from	
-			printf("Error writing to i2c slave (write cal reg)\n");
-			return(1);
-		}
-		usleep(10000);
-		if (read(sensor->fd, buf, 2) != 2) {								// Read back data into buf[]
+		if (i2c_bus_write_read(sensor->bus, sensor->address, buf, 1, buf, 2) != 0) {	// Send register and read back data into buf[]
 			printf("Unable to read from slave (get cal reg)\n");
 			return(1);
 		}
@@ -203,7 +250,7 @@ int ms5611_reset(t_ms5611 *sensor)
 	
 	// reset sensor
 	buf[0] = 0x1E;										// This is the register we want to read from
-	if ((write(sensor->fd, buf, 1)) != 1) {				// Send register we want to read from	
+	if (i2c_bus_write(sensor->bus, sensor->address, buf, 1) != 0) {	// Send register we want to read from	
 		printf("Error writing to i2c slave (%s)\n", __func__);
 		return(1);
 	}
@@ -225,8 +272,8 @@ int ms5611_start_temp(t_ms5611 *sensor)
 	unsigned char buf[10]={0x00};
 
 	// start conversion for D2
-	buf[0] = 0x58;										// This is the register we want to read from
-	if ((write(sensor->fd, buf, 1)) != 1) {				// Send register we want to read from	
+	buf[0] = 0x50 | sensor->osr_cmd;					// This is the register we want to read from
+	if (i2c_bus_write(sensor->bus, sensor->address, buf, 1) != 0) {	// Send register we want to read from	
 		printf("Error writing to i2c slave (%s)\n", __func__);
 		return(1);
 	}
@@ -249,8 +296,8 @@ int ms5611_start_pressure(t_ms5611 *sensor)
 	uint8_t buf[10]={0x00};
 	
 	// start conversion for D1
-	buf[0] = 0x48;													// This is the register we want to read from
-	if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from	
+	buf[0] = 0x40 | sensor->osr_cmd;								// This is the register we want to read from
+	if (i2c_bus_write(sensor->bus, sensor->address, buf, 1) != 0) {	// Send register we want to read from	
 		printf("Error writing to i2c slave: start conv: adr %x\n",sensor->address);
 		return(1);
 	}
@@ -268,23 +315,46 @@ int ms5611_start_pressure(t_ms5611 *sensor)
 */ 
 int ms5611_read_temp(t_ms5611 *sensor)
 {
-	//variables
-	uint8_t buf[10]={0x00};
-	
 	// read result
-	buf[0] = 0x00;
-	if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from	
-		printf("Error writing to i2c slave(%s)\n", __func__);
-		return(1);
-	}
-	
-	if (read(sensor->fd, buf, 3) != 3) {								// Read back data into buf[]
+	sensor->cmd = 0x00;
+	if (i2c_bus_write_read(sensor->bus, sensor->address, &sensor->cmd, 1, sensor->adc, 3) != 0) {	// Send ADC read command and read back data into adc[]
 		printf("Unable to read from slave(%s)\n", __func__);
 		return(1);
 	}
 	
+	return (ms5611_decode_temp(sensor));
+}
+
+/**
+* @brief Sensitivity of pressure to temperature reading
+* @param sensor pointer to sensor instance
+* @return pressure change (Pa) per LSB of dT at last pressure reading
+*
+* A pressure reading compensated with a temperature reading which is off
+* by x LSB of dT is off by x times this value.
+* @date 17.10.2026 born
+*
+*/
+float ms5611_pressure_per_dT(t_ms5611 *sensor)
+{
+	// derivative of P = (D1 * SENS / 2**21 - OFF) / 2**15 after dT
+	return (sensor->linearity * ((float)sensor->D1 * sensor->C3 / 536870912.0 - sensor->C4 / 128.0) / 32768.0);
+}
+
+/**
+* @brief Calculate temperature from ADC result of MS5611 sensor
+* @param sensor pointer to sensor instance
+* @return result
+*
+* Expects the ADC result in sensor->adc, read by ms5611_read_temp or
+* a batch prepared with ms5611_batch_read.
+* @date 17.10.2026 born
+*
+*/ 
+int ms5611_decode_temp(t_ms5611 *sensor)
+{
 	// Put temperature readings together
-	sensor->D2 = (buf[0] << 16) + (buf[1] << 8) + buf[2];
+	sensor->D2 = (sensor->adc[0] << 16) + (sensor->adc[1] << 8) + sensor->adc[2];
 
 	// calculate dT and absolute temperature
 	sensor->dT = sensor->D2 - sensor->C5s;
@@ -308,27 +378,35 @@ int ms5611_read_temp(t_ms5611 *sensor)
 */ 
 int ms5611_read_pressure(t_ms5611 *sensor)
 {
-	//variables
-	//long d2;
-	uint8_t buf[10]={0x00};
-	int64_t OFF2=0;
-	int64_t SENS2=0;
-	int64_t T2=0;
-	
 	// read result
-	buf[0] = 0x00;
-	if ((write(sensor->fd, buf, 1)) != 1) {								// Send register we want to read from	
-		printf("Error writing to i2c slave: write Read result(%s)\n", __func__);
-		return(1);
-	}
-	
-	if (read(sensor->fd, buf, 3) != 3) {								// Read back data into buf[]
+	sensor->cmd = 0x00;
+	if (i2c_bus_write_read(sensor->bus, sensor->address, &sensor->cmd, 1, sensor->adc, 3) != 0) {	// Send ADC read command and read back data into adc[]
 		printf("Unable to read from slave: read result(%s)\n", __func__);
 		return(1);
 	}
 	
+	return (ms5611_decode_pressure(sensor));
+}
+
+/**
+* @brief Calculate pressure from ADC result of MS5611 sensor
+* @param sensor pointer to sensor instance
+* @return result
+*
+* Expects the ADC result in sensor->adc, read by ms5611_read_pressure or
+* a batch prepared with ms5611_batch_read.
+* @date 17.10.2026 born
+*
+*/ 
+int ms5611_decode_pressure(t_ms5611 *sensor)
+{
+	//variables
+	int64_t OFF2=0;
+	int64_t SENS2=0;
+	int64_t T2=0;
+	
 	// put pressure reading together
-	sensor->D1 = (buf[0] << 16) + (buf[1] << 8) + buf[2];
+	sensor->D1 = (sensor->adc[0] << 16) + (sensor->adc[1] << 8) + sensor->adc[2];
 
 	// these calculations are copied from the data sheet
 	//OFF = C2 * 2**16 + (C4 * dT) / 2**7
@@ -379,4 +457,56 @@ int ms5611_read_pressure(t_ms5611 *sensor)
 		// TODO add error handling here !!
 		return(1);
 	}
-}
\ No newline at end of file
+}
+
+/**
+* @brief Add temperature conversion command to batch
+* @param sensor pointer to sensor instance
+* @param batch pointer to batch
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/ 
+int ms5611_batch_start_temp(t_ms5611 *sensor, t_i2c_batch *batch)
+{
+	// start conversion for D2
+	sensor->cmd = 0x50 | sensor->osr_cmd;
+	return (i2c_batch_add_write(batch, sensor->address, &sensor->cmd, 1));
+}
+
+/**
+* @brief Add pressure conversion command to batch
+* @param sensor pointer to sensor instance
+* @param batch pointer to batch
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/ 
+int ms5611_batch_start_pressure(t_ms5611 *sensor, t_i2c_batch *batch)
+{
+	// start conversion for D1
+	sensor->cmd = 0x40 | sensor->osr_cmd;
+	return (i2c_batch_add_write(batch, sensor->address, &sensor->cmd, 1));
+}
+
+/**
+* @brief Add ADC read to batch
+* @param sensor pointer to sensor instance
+* @param batch pointer to batch
+* @return result
+*
+* After the batch was run, the result is calculated by ms5611_decode_temp
+* or ms5611_decode_pressure, depending on the conversion started before.
+* @date 17.10.2026 born
+*
+*/ 
+int ms5611_batch_read(t_ms5611 *sensor, t_i2c_batch *batch)
+{
+	sensor->cmd = 0x00;
+	if (i2c_batch_add_write(batch, sensor->address, &sensor->cmd, 1) != 0)
+		return 1;
+
+	return (i2c_batch_add_read(batch, sensor->address, sensor->adc, 3));
+}
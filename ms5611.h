@@ -19,12 +19,14 @@
 
 #include <time.h>
 #include <stdint.h>
+#include "i2c_bus.h"
 
 // variable definitions
+#define MS5611_DEFAULT_OSR	4096	// oversampling ratio after reset of sensor object
 
 // define struct for MS5611 sensor
 typedef struct {
-	int fd;
+	t_i2c_bus *bus;
 	unsigned char address;
 	uint32_t C1s;
 	uint32_t C2s;
@@ -44,6 +46,10 @@ typedef struct {
 	float offset;
 	int valid;
 	int secordcomp;
+	int osr;					// oversampling ratio 256 .. 4096
+	uint8_t osr_cmd;			// OSR bits of conversion commands
+	uint8_t cmd;				// command buffer for batched transfers
+	uint8_t adc[3];				// ADC result of batched transfers
 } t_ms5611;
 
 // prototypes
@@ -51,9 +57,18 @@ int ms5611_init(t_ms5611 *);
 int ms5611_reset(t_ms5611 *);
 int ms5611_measure(t_ms5611 *);
 int ms5611_calculate(t_ms5611 *);
-int ms5611_open(t_ms5611 *, unsigned char);
+int ms5611_open(t_ms5611 *, t_i2c_bus *, unsigned char);
+int ms5611_set_osr(t_ms5611 *, int);
+long ms5611_conversion_ns(int);
+float ms5611_pressure_per_dT(t_ms5611 *);
 
 int ms5611_read_pressure(t_ms5611 *);
 int ms5611_read_temp(t_ms5611 *);
 int ms5611_start_temp(t_ms5611 *);
-int ms5611_start_pressure(t_ms5611 *);
\ No newline at end of file
+int ms5611_start_pressure(t_ms5611 *);
+
+int ms5611_batch_start_temp(t_ms5611 *, t_i2c_batch *);
+int ms5611_batch_start_pressure(t_ms5611 *, t_i2c_batch *);
+int ms5611_batch_read(t_ms5611 *, t_i2c_batch *);
+int ms5611_decode_temp(t_ms5611 *);
+int ms5611_decode_pressure(t_ms5611 *);
\ No newline at end of file
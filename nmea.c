@@ -19,11 +19,140 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "nmea.h"
 #include "def.h"
 
+#define NMEA_FIXED_MAX		1000000000	// larger scaled values are formatted by sprintf
+
+// XOR of the constant parts of the sentences, for the checksum
+#define NMEA_XOR_POV_P		0x19	// "POV,P,"
+#define NMEA_XOR_Q			0x51	// ",Q,"
+#define NMEA_XOR_POV_E		0x0C	// "POV,E,"
+#define NMEA_XOR_POV_V		0x1F	// "POV,V,"
+#define NMEA_XOR_POVSEQ		0x22	// "POVSEQ,"
+
 extern int g_debug;
 extern FILE *fp_console;
+
+static const char nmea_hex[] = "0123456789ABCDEF";
+
+/**
+* @brief Write number like printf "%+0<width>.<decimals>f"
+* @param buf output buffer
+* @param value number, must be a float converted to double if decimals > 0
+* @param decimals number of digits after the decimal point, 0..2
+* @param width min. field width, zeros are inserted after the sign
+* @param plus 1 to write '+' for positive values
+* @param checksum NMEA checksum, updated with all written characters
+* @return number of characters written, -1 if value is too large or not finite
+*
+* value * 10^decimals is exact for a float, so rounding it with lrint gives
+* the same digits as printf, including ties to even and "-0.00".
+* @date 17.10.2026 born
+*
+*/
+static int nmea_put_fixed(char *buf, double value, int decimals, int width, int plus, unsigned char *checksum)
+{
+	static const long scale[] = { 1, 10, 100 };
+	char digits[12];
+	double scaled = value * scale[decimals];
+	unsigned long v;
+	unsigned char cs = *checksum;
+	char *p = buf;
+	int n = 0;
+	int length;
+
+	// false for NaN, too
+	if (!(fabs(scaled) < NMEA_FIXED_MAX))
+		return -1;
+
+	// digits in reverse order, at least one before the decimal point
+	v = (unsigned long)lrint(fabs(scaled));
+	do {
+		digits[n++] = '0' + v % 10;
+		v /= 10;
+	} while (v != 0 || n <= decimals);
+
+	length = n + (decimals > 0) + ((signbit(value) || plus) ? 1 : 0);
+
+	if (signbit(value))
+		*p++ = '-';
+	else if (plus)
+		*p++ = '+';
+
+	for (; length < width; length++)
+		*p++ = '0';
+
+	while (n > decimals)
+		*p++ = digits[--n];
+
+	if (decimals > 0)
+	{
+		*p++ = '.';
+		while (n > 0)
+			*p++ = digits[--n];
+	}
+
+	for (n = 0; n < p - buf; n++)
+		cs ^= buf[n];
+	*checksum = cs;
+
+	return (p - buf);
+}
+
+/**
+* @brief Write "*<checksum>\n" and terminate string
+* @param buf output buffer
+* @param checksum NMEA checksum
+* @return number of characters written
+*
+* @date 17.10.2026 born
+*
+*/
+static int nmea_put_checksum(char *buf, unsigned char checksum)
+{
+	buf[0] = '*';
+	buf[1] = nmea_hex[checksum >> 4];
+	buf[2] = nmea_hex[checksum & 0x0F];
+	buf[3] = '\n';
+	buf[4] = '\0';
+
+	return 4;
+}
+
+/**
+* @brief Compose "$POV,<code>,%+05.2f*<checksum>\n"
+* @param sentence buffer for created string
+* @param prefix "$POV,<code>," (7 characters)
+* @param prefix_xor XOR of prefix without '$'
+* @param value number
+* @return length of sentence
+*
+* @date 17.10.2026 born
+*
+*/
+static int nmea_compose_pov(char *sentence, const char *prefix, unsigned char prefix_xor, float value)
+{
+	unsigned char checksum = prefix_xor;
+	int length;
+
+	memcpy(sentence, prefix, 7);
+	length = nmea_put_fixed(sentence + 7, value, 2, 5, 1, &checksum);
+
+	if (length < 0)
+	{
+		// not finite, format as sprintf does
+		length = sprintf(sentence, "%s%+05.2f", prefix, value);
+		length += sprintf(sentence + length, "*%02X\n", NMEA_checksum(sentence));
+		return length;
+	}
+
+	length += 7;
+	length += nmea_put_checksum(sentence + length, checksum);
+
+	return length;
+}
  	
 /**
 * @brief Implements the $POV NMEA Sentence for pressure data
@@ -31,6 +160,7 @@ extern FILE *fp_console;
 * @param static_pressure
 * @param dynamic_pressure
 * @param tek_pressure // not implemented yet !!
+* @param sentence_length length of created string
 * @return result
 * 
 * Implementation of the properitary NMEA sentence for AKF Glidecomputer
@@ -55,13 +185,16 @@ extern FILE *fp_console;
 *   
 *
 * @date 23.02.2014 born
+* @date 17.10.2026 revised
 *
 */ 
 		
-int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynamic_pressure)
+int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynamic_pressure, int *sentence_length)
 {
 	int length;
+	int n;
 	int success = 1;
+	unsigned char checksum;
 
 	// check static_pressure input value for validity
 	if ((static_pressure < 0) || (static_pressure > 2000))
@@ -78,11 +211,33 @@ int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynam
 		success = 20;
 	}
 
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,P,%+07.2f,Q,%+05.2f", static_pressure, (dynamic_pressure)); 
+	// compose NMEA String, checksum is calculated while writing
+	checksum = NMEA_XOR_POV_P;
+	memcpy(sentence, "$POV,P,", 7);
+	length = 7;
+	
+	n = nmea_put_fixed(sentence + length, static_pressure, 2, 7, 1, &checksum);
+	if (n >= 0)
+	{
+		length += n;
+		memcpy(sentence + length, ",Q,", 3);
+		checksum ^= NMEA_XOR_Q;
+		length += 3;
+		n = nmea_put_fixed(sentence + length, dynamic_pressure, 2, 5, 1, &checksum);
+	}
 	
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\n", NMEA_checksum(sentence));
+	if (n >= 0)
+	{
+		length += n;
+		length += nmea_put_checksum(sentence + length, checksum);
+	}
+	else
+	{
+		// not finite
+		length = sprintf(sentence, "$POV,P,%+07.2f,Q,%+05.2f", static_pressure, (dynamic_pressure)); 
+		length += sprintf(sentence + length, "*%02X\n", NMEA_checksum(sentence));
+	}
+	*sentence_length = length;
 	
 	//print sentence for debug
 	debug_print("POV slow NMEA sentence: %s\n", sentence);
@@ -93,6 +248,7 @@ int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynam
 * @brief Implements the $POV NMEA Sentence for fast data
 * @param sentence char pointer for created string
 * @param TE vario
+* @param sentence_length length of created string
 * @return result
 * 
 * Implementation of the properitary NMEA sentence for AKF Glidecomputer
@@ -110,12 +266,12 @@ int Compose_Pressure_POV_slow(char *sentence, float static_pressure, float dynam
 *     3: TE vario           Format: 3.4
 *
 * @date 09.03.2014 born
+* @date 17.10.2026 revised
 *
 */ 
 		
-int Compose_Pressure_POV_fast(char *sentence, float te_vario)
+int Compose_Pressure_POV_fast(char *sentence, float te_vario, int *sentence_length)
 {
-	int length;
 	int success = 1;
 
 	// check te_vario input value for validity
@@ -125,11 +281,8 @@ int Compose_Pressure_POV_fast(char *sentence, float te_vario)
 		success = 10;
 	}
 	
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,E,%+05.2f", te_vario); 
-	
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\n", NMEA_checksum(sentence));
+	// compose NMEA String with checksum
+	*sentence_length = nmea_compose_pov(sentence, "$POV,E,", NMEA_XOR_POV_E, te_vario);
 	
 	//print sentence for debug
 	debug_print("NMEA sentence: %s\n", sentence);
@@ -140,6 +293,7 @@ int Compose_Pressure_POV_fast(char *sentence, float te_vario)
 * @brief Implements the $POV NMEA Sentence for voltage data
 * @param sentence char pointer for created string
 * @param Battery Voltage
+* @param sentence_length length of created string
 * @return result
 * 
 * Implementation of the properitary NMEA sentence for AKF Glidecomputer
@@ -157,12 +311,12 @@ int Compose_Pressure_POV_fast(char *sentence, float te_vario)
 *     3: Battery Voltage           Format: 12.02
 *
 * @date 13.03.2016 born
+* @date 17.10.2026 revised
 *
 */ 
 
-int Compose_Voltage_POV(char *sentence, float voltage)
+int Compose_Voltage_POV(char *sentence, float voltage, int *sentence_length)
 {
-	int length;
 	int success = 1;
 
 	// check voltage input value for validity
@@ -172,11 +326,8 @@ int Compose_Voltage_POV(char *sentence, float voltage)
 		success = 10;
 	}
 	
-	// compose NMEA String
-	length = sprintf(sentence, "$POV,V,%+05.2f", voltage); 
-	
-	// Calculate NMEA checksum and add to string
-	sprintf(sentence + length, "*%02X\n", NMEA_checksum(sentence));
+	// compose NMEA String with checksum
+	*sentence_length = nmea_compose_pov(sentence, "$POV,V,", NMEA_XOR_POV_V, voltage);
 	
 	//print sentence for debug
 	debug_print("NMEA sentence: %s\n", sentence);
@@ -206,3 +357,97 @@ unsigned char NMEA_checksum(char *string)
   }
   return value;
 }
+
+/**
+* @brief Compose $RPYL sentence with fixed-point formatting
+* @param sentence buffer for created string, at least NMEA_RPYL_SIZE
+* @param values roll, pitch, heading and G
+* @return length of sentence, -1 if a value is too large or not finite
+*
+* @date 17.10.2026 born
+*
+*/
+static int nmea_compose_rpyl(char *sentence, const double *values)
+{
+	static const char *separators[] = { ",", ",", ",0,0,", ",0\r\n" };
+	static const int separator_lengths[] = { 1, 1, 5, 4 };
+	unsigned char checksum = 0;
+	char *p = sentence;
+	int i, n;
+
+	memcpy(p, "$RPYL,", 6);
+	p += 6;
+
+	for (i = 0; i < 4; i++)
+	{
+		n = nmea_put_fixed(p, values[i], 0, 0, 0, &checksum);
+		if (n < 0)
+			return -1;
+		p += n;
+
+		memcpy(p, separators[i], separator_lengths[i] + 1);
+		p += separator_lengths[i];
+	}
+
+	return (p - sentence);
+}
+
+/**
+* @brief Implements the $RPYL sentence of the LevilAHRS driver
+* @param sentence char pointer for created string
+* @param size size of buffer
+* @param roll roll in 0.1 deg
+* @param pitch pitch in 0.1 deg
+* @param heading magnetic heading in 0.1 deg
+* @param g magnitude of acceleration in mG, negative if upside down
+* @return length of sentence, 0 if it did not fit
+*
+*     $RPYL,Roll,Pitch,MagnHeading,SideSlip,YawRate,G,errorcode
+*
+* Values are rounded like printf "%0.0f". SideSlip, YawRate and errorcode
+* are always 0, there is no checksum.
+* @date 17.10.2026 born
+*
+*/
+int Compose_RPYL(char *sentence, size_t size, double roll, double pitch, double heading, double g)
+{
+	double values[4];
+	int n;
+
+	values[0] = roll;
+	values[1] = pitch;
+	values[2] = heading;
+	values[3] = g;
+
+	if (size >= NMEA_RPYL_SIZE && (n = nmea_compose_rpyl(sentence, values)) >= 0)
+		return n;
+
+	n = snprintf(sentence, size, "$RPYL,%0.0f,%0.0f,%0.0f,0,0,%0.0f,0\r\n", roll, pitch, heading, g);
+	if (n < 0 || (size_t)n >= size)
+		return 0;
+
+	return n;
+}
+
+/**
+* @brief Implements the $POVSEQ sentence for the sequence number of UDP datagrams
+* @param sentence buffer for created string, at least NMEA_SEQ_SIZE
+* @param seq sequence number, counts modulo 10^9
+* @return length of sentence
+*
+*     $POVSEQ,<seq>*<checksum>
+*
+* @date 17.10.2026 born
+*
+*/
+int Compose_Sequence(char *sentence, unsigned long seq)
+{
+	unsigned char checksum = NMEA_XOR_POVSEQ;
+	int length;
+
+	memcpy(sentence, "$POVSEQ,", 8);
+	length = 8 + nmea_put_fixed(sentence + 8, seq % NMEA_FIXED_MAX, 0, 0, 0, &checksum);
+	length += nmea_put_checksum(sentence + length, checksum);
+
+	return length;
+}
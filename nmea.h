@@ -20,9 +20,16 @@
 #ifndef NMEA_H
 #define NMEA_H 
 
+#include <stddef.h>
+
+#define NMEA_RPYL_SIZE	64	// buffer size for $RPYL sentence with fast formatting
+#define NMEA_SEQ_SIZE	24	// buffer size for $POVSEQ sentence
+
 unsigned char NMEA_checksum(char *);
-int Compose_Pressure_POV_slow(char *, float, float);
-int Compose_Pressure_POV_fast(char *, float);
-int Compose_Voltage_POV(char *sentence, float voltage);
+int Compose_Pressure_POV_slow(char *, float, float, int *);
+int Compose_Pressure_POV_fast(char *, float, int *);
+int Compose_Voltage_POV(char *sentence, float voltage, int *sentence_length);
+int Compose_RPYL(char *, size_t, double, double, double, double);
+int Compose_Sequence(char *, unsigned long);
 
 #endif
\ No newline at end of file
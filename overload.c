@@ -0,0 +1,154 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "overload.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *level_names[OVERLOAD_LEVELS] = {
+	"none",
+	"ahrs",
+	"ahrs+voltage",
+	"ahrs+voltage+temp"
+};
+
+/**
+* @brief Initialize load shedding state
+* @param overload pointer to instance
+* @param threshold deadline misses per window which raise the level
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void overload_init(t_overload *overload, unsigned int threshold)
+{
+	memset(overload, 0, sizeof(t_overload));
+	overload->threshold = (threshold > 0) ? threshold : 1;
+}
+
+/**
+* @brief Update shedding level at end of window
+* @param overload pointer to instance
+* @param misses total number of deadline misses so far
+* @return new level
+*
+* Every window with at least threshold misses raises the level by one.
+* The level is lowered by one after OVERLOAD_RECOVER_WINDOWS windows
+* without miss, windows with fewer misses hold the level. So single late
+* ticks do not make the level oscillate. Must be called by one thread
+* only.
+* @date 17.10.2026 born
+*
+*/
+int overload_update(t_overload *overload, unsigned long long misses)
+{
+	int level = overload->level;
+
+	overload->windows++;
+	overload->level_windows[level]++;
+
+	if (misses - overload->misses >= overload->threshold)
+	{
+		overload->clean_windows = 0;
+		if (level < OVERLOAD_LEVELS - 1)
+		{
+			level++;
+			overload->raised++;
+		}
+	}
+	else if (misses != overload->misses)
+	{
+		overload->clean_windows = 0;
+	}
+	else if (++overload->clean_windows >= OVERLOAD_RECOVER_WINDOWS)
+	{
+		overload->clean_windows = 0;
+		if (level > OVERLOAD_NONE)
+		{
+			level--;
+			overload->lowered++;
+		}
+	}
+
+	overload->misses = misses;
+	if (level > overload->max_level)
+		overload->max_level = level;
+
+	__atomic_store_n(&overload->level, level, __ATOMIC_RELAXED);
+
+	return level;
+}
+
+/**
+* @brief Current shedding level
+* @param overload pointer to instance
+* @return level
+*
+* Can be called from any thread.
+* @date 17.10.2026 born
+*
+*/
+int overload_level(t_overload *overload)
+{
+	return __atomic_load_n(&overload->level, __ATOMIC_RELAXED);
+}
+
+/**
+* @brief Name of shedding level
+* @param level shedding level
+* @return name
+*
+* @date 17.10.2026 born
+*
+*/
+const char *overload_level_name(int level)
+{
+	if (level < 0 || level >= OVERLOAD_LEVELS)
+		return "?";
+
+	return level_names[level];
+}
+
+/**
+* @brief Print load shedding statistics
+* @param overload pointer to instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void overload_print_stats(t_overload *overload, FILE *fp)
+{
+	int i;
+
+	fprintf(fp, "  shedding level: %d (%s) max: %d raised: %lu lowered: %lu deadline misses: %llu\n",
+		overload_level(overload),
+		overload_level_name(overload_level(overload)),
+		overload->max_level,
+		overload->raised,
+		overload->lowered,
+		overload->misses);
+
+	fprintf(fp, "  windows ");
+	for (i = 0; i < OVERLOAD_LEVELS; i++)
+		fprintf(fp, " %s: %lu", overload_level_name(i), overload->level_windows[i]);
+	fprintf(fp, "\n");
+}
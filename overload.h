@@ -0,0 +1,56 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OVERLOAD_H
+#define OVERLOAD_H
+
+#include <stdio.h>
+
+#define OVERLOAD_RECOVER_WINDOWS	5	// windows without deadline miss before the level is lowered
+
+// shedding levels, every level includes the ones below
+enum {
+	OVERLOAD_NONE,
+	OVERLOAD_AHRS,				// AHRS output rate lowered
+	OVERLOAD_VOLTAGE,			// voltage read less often
+	OVERLOAD_TEMP,				// temperature refreshed at max. interval
+	OVERLOAD_LEVELS
+};
+
+// define struct for load shedding state, updated once per window
+typedef struct {
+	int level;						// written by owner, read by all threads
+	int max_level;
+	int clean_windows;				// consecutive windows without miss
+	unsigned int threshold;			// misses per window which raise the level
+	unsigned long long misses;		// total deadline misses at last update
+	unsigned long windows;
+	unsigned long raised;
+	unsigned long lowered;
+	unsigned long level_windows[OVERLOAD_LEVELS];
+} t_overload;
+
+// prototypes
+void overload_init(t_overload *, unsigned int);
+int overload_update(t_overload *, unsigned long long);
+int overload_level(t_overload *);
+const char *overload_level_name(int);
+void overload_print_stats(t_overload *, FILE *);
+
+#endif
@@ -0,0 +1,416 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "reactor.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "timer.h"
+#include "def.h"
+
+extern int g_debug;
+extern FILE *fp_console;
+
+/**
+* @brief Initialize event loop
+* @param reactor pointer to event loop instance
+* @return result
+*
+* The loop counts as running from here on, so a reactor_stop from another
+* thread before reactor_run is not lost.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int reactor_init(t_reactor *reactor)
+{
+	struct epoll_event ev;
+
+	memset(reactor, 0, sizeof(t_reactor));
+	reactor->running = 1;
+
+	reactor->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (reactor->epfd < 0)
+	{
+		fprintf(stderr, "epoll_create1 failed: %s\n", strerror(errno));
+		return 1;
+	}
+
+	reactor->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (reactor->stop_fd < 0)
+	{
+		fprintf(stderr, "eventfd failed: %s\n", strerror(errno));
+		close(reactor->epfd);
+		return 1;
+	}
+
+	// no event object, only wakes up epoll_wait
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, reactor->stop_fd, &ev) < 0)
+	{
+		fprintf(stderr, "epoll_ctl failed (stop): %s\n", strerror(errno));
+		close(reactor->stop_fd);
+		close(reactor->epfd);
+		return 1;
+	}
+
+	return (0);
+}
+
+static int reactor_register(t_reactor *reactor, t_reactor_event *event)
+{
+	struct epoll_event ev;
+
+	if (reactor->num_events >= REACTOR_MAX_EVENTS)
+	{
+		fprintf(stderr, "Too many events in reactor (%s)\n", event->name);
+		return 1;
+	}
+
+	// peer hangup is reported as readable, the handler sees EOF
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLRDHUP;
+	ev.data.ptr = event;
+
+	if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, event->fd, &ev) < 0)
+	{
+		fprintf(stderr, "epoll_ctl failed (%s): %s\n", event->name, strerror(errno));
+		return 1;
+	}
+
+	reactor->events[reactor->num_events++] = event;
+	return (0);
+}
+
+/**
+* @brief Add periodic timer to event loop
+* @param reactor pointer to event loop instance
+* @param event pointer to event object
+* @param name name of event for statistics
+* @param period_ns period of timer in ns
+* @param offset_ns first expiry relative to start of loop in ns
+* @param handler function called on expiry
+* @param arg argument for handler
+* @return result
+*
+* The timer runs on CLOCK_MONOTONIC with absolute deadlines, so the runtime
+* of the handlers does not shift later expiries.
+* @date 17.10.2026 born
+*
+*/
+int reactor_add_timer(t_reactor *reactor, t_reactor_event *event, const char *name, long long period_ns, long long offset_ns, t_reactor_handler handler, void *arg)
+{
+	memset(event, 0, sizeof(t_reactor_event));
+	event->name = name;
+	event->period_ns = period_ns;
+	event->offset_ns = offset_ns;
+	event->handler = handler;
+	event->arg = arg;
+
+	event->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (event->fd < 0)
+	{
+		fprintf(stderr, "timerfd_create failed (%s): %s\n", name, strerror(errno));
+		return 1;
+	}
+
+	return (reactor_register(reactor, event));
+}
+
+/**
+* @brief Add file descriptor to event loop
+* @param reactor pointer to event loop instance
+* @param event pointer to event object
+* @param name name of event for statistics
+* @param fd file descriptor to watch for input
+* @param handler function called when fd is readable
+* @param arg argument for handler
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int reactor_add_fd(t_reactor *reactor, t_reactor_event *event, const char *name, int fd, t_reactor_handler handler, void *arg)
+{
+	memset(event, 0, sizeof(t_reactor_event));
+	event->name = name;
+	event->fd = fd;
+	event->handler = handler;
+	event->arg = arg;
+
+	return (reactor_register(reactor, event));
+}
+
+/**
+* @brief Remove file descriptor from event loop
+* @param reactor pointer to event loop instance
+* @param event pointer to event object
+* @return
+*
+* Must be called before the fd is closed, or before the event object is
+* reused. Events which are not registered are ignored, so it is safe to
+* call it more than once. The fd itself is not closed.
+* @date 17.10.2026 born
+*
+*/
+void reactor_remove(t_reactor *reactor, t_reactor_event *event)
+{
+	int i;
+
+	for (i = 0; i < reactor->num_events; i++)
+	{
+		if (reactor->events[i] == event)
+			break;
+	}
+
+	if (i == reactor->num_events)
+		return;
+
+	// fails if the fd was closed already, epoll dropped it then
+	epoll_ctl(reactor->epfd, EPOLL_CTL_DEL, event->fd, NULL);
+
+	// keep order of the remaining events for the statistics
+	memmove(&reactor->events[i], &reactor->events[i + 1], (reactor->num_events - i - 1) * sizeof(t_reactor_event *));
+	reactor->num_events--;
+}
+
+/**
+* @brief Arm all timers of the event loop relative to now
+* @param reactor pointer to event loop instance
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+static int reactor_arm_timers(t_reactor *reactor)
+{
+	int i;
+	struct timespec start;
+	struct itimerspec its;
+	t_reactor_event *event;
+
+	timer_now(&start);
+
+	for (i = 0; i < reactor->num_events; i++)
+	{
+		event = reactor->events[i];
+		if (event->period_ns == 0)
+			continue;
+
+		event->deadline = start;
+		timespec_add_ns(&event->deadline, event->offset_ns);
+		event->stats.last_run.tv_sec = 0;
+		event->stats.last_run.tv_nsec = 0;
+
+		its.it_value = event->deadline;
+		its.it_interval.tv_sec = event->period_ns / NSEC_PER_SEC;
+		its.it_interval.tv_nsec = event->period_ns % NSEC_PER_SEC;
+
+		if (timerfd_settime(event->fd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+		{
+			fprintf(stderr, "timerfd_settime failed (%s): %s\n", event->name, strerror(errno));
+			return 1;
+		}
+	}
+
+	return (0);
+}
+
+/**
+* @brief Account timer expiry in event statistics
+* @param event pointer to event object
+* @param expirations number of expirations reported by timerfd
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void reactor_timer_stats(t_reactor_event *event, uint64_t expirations)
+{
+	struct timespec now;
+	long long lateness;
+	long long deviation;
+
+	timer_now(&now);
+
+	// the deadline we were woken up for is the last one which expired
+	timespec_add_ns(&event->deadline, (long long)(expirations - 1) * event->period_ns);
+	lateness = timespec_diff_ns(&now, &event->deadline);
+
+	event->stats.lateness_sum_ns += lateness;
+	if (lateness > event->stats.lateness_max_ns)
+		event->stats.lateness_max_ns = lateness;
+
+	event->stats.overruns += expirations - 1;
+
+	if (event->stats.last_run.tv_sec != 0)
+	{
+		deviation = timespec_diff_ns(&now, &event->stats.last_run) - (long long)expirations * event->period_ns;
+		if (deviation < 0)
+			deviation = -deviation;
+		if (deviation > event->stats.period_dev_max_ns)
+			event->stats.period_dev_max_ns = deviation;
+	}
+
+	event->stats.last_run = now;
+	event->stats.count++;
+
+	// next deadline
+	timespec_add_ns(&event->deadline, event->period_ns);
+}
+
+/**
+* @brief Count deadline miss of timer handler
+* @param event pointer to event object
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void reactor_check_deadline(t_reactor_event *event)
+{
+	struct timespec now;
+
+	timer_now(&now);
+	if (timespec_diff_ns(&now, &event->deadline) > 0)
+		event->stats.misses++;
+}
+
+/**
+* @brief Run event loop until reactor_stop is called
+* @param reactor pointer to event loop instance
+* @return result
+*
+* Returns at once, if reactor_stop was called before.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int reactor_run(t_reactor *reactor)
+{
+	struct epoll_event evs[REACTOR_MAX_EVENTS];
+	t_reactor_event *event;
+	uint64_t expirations;
+	int n, i;
+
+	if (reactor_arm_timers(reactor) != 0)
+		return 1;
+
+	while (__atomic_load_n(&reactor->running, __ATOMIC_ACQUIRE))
+	{
+		n = epoll_wait(reactor->epfd, evs, REACTOR_MAX_EVENTS, -1);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			fprintf(stderr, "epoll_wait failed: %s\n", strerror(errno));
+			return 1;
+		}
+
+		for (i = 0; i < n && __atomic_load_n(&reactor->running, __ATOMIC_ACQUIRE); i++)
+		{
+			event = evs[i].data.ptr;
+			if (event == NULL)
+				continue;
+
+			if (event->period_ns != 0)
+			{
+				if (read(event->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+					continue;
+
+				reactor_timer_stats(event, expirations);
+			}
+			else
+			{
+				event->stats.count++;
+			}
+
+			event->handler(event->arg);
+
+			// the deadline of a timer handler is the next expiry
+			if (event->period_ns != 0)
+				reactor_check_deadline(event);
+		}
+	}
+
+	return (0);
+}
+
+/**
+* @brief Stop event loop after current handler returned
+* @param reactor pointer to event loop instance
+* @return
+*
+* May be called from any thread, a loop waiting in epoll_wait is woken up.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+void reactor_stop(t_reactor *reactor)
+{
+	uint64_t one = 1;
+
+	__atomic_store_n(&reactor->running, 0, __ATOMIC_RELEASE);
+
+	if (write(reactor->stop_fd, &one, sizeof(one)) != sizeof(one))
+		return;
+}
+
+/**
+* @brief Print timing statistics of all timers
+* @param reactor pointer to event loop instance
+* @param fp file pointer for output
+* @return
+*
+* Lateness is the time between a deadline and the handler call. Period
+* deviation compares the interval between two handler calls with the
+* nominal period. A miss is a handler which returned after the next expiry.
+* @date 17.10.2026 born
+*
+*/
+void reactor_print_stats(t_reactor *reactor, FILE *fp)
+{
+	int i;
+	t_reactor_event *event;
+
+	for (i = 0; i < reactor->num_events; i++)
+	{
+		event = reactor->events[i];
+		if (event->period_ns == 0 || event->stats.count == 0)
+			continue;
+
+		fprintf(fp, "  %-8s %7.2fHz runs: %lld overruns: %lld misses: %lld lateness avg: %lldus max: %lldus jitter max: %lldus\n",
+			event->name,
+			1e9 / event->period_ns,
+			event->stats.count,
+			event->stats.overruns,
+			event->stats.misses,
+			event->stats.lateness_sum_ns / event->stats.count / 1000,
+			event->stats.lateness_max_ns / 1000,
+			event->stats.period_dev_max_ns / 1000);
+	}
+}
@@ -0,0 +1,71 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdio.h>
+#include <time.h>
+
+#define REACTOR_MAX_EVENTS	48			// includes the clients of the servers
+
+typedef void (*t_reactor_handler)(void *);
+
+// timing statistics of one event source
+typedef struct {
+	long long count;				// number of handler calls
+	long long overruns;				// timer expirations which were skipped
+	long long misses;				// handler finished after the next expiry
+	long long lateness_sum_ns;		// sum of wakeup - deadline
+	long long lateness_max_ns;		// worst wakeup - deadline
+	long long period_dev_max_ns;	// worst |interval - period| between two runs
+	struct timespec last_run;
+} t_reactor_stats;
+
+// define struct for one event source (timer or file descriptor)
+typedef struct {
+	const char *name;
+	int fd;
+	long long period_ns;			// 0 for plain file descriptor events
+	long long offset_ns;			// first expiry relative to start of loop
+	struct timespec deadline;		// next absolute expiry
+	t_reactor_handler handler;
+	void *arg;
+	t_reactor_stats stats;
+} t_reactor_event;
+
+// define struct for event loop
+typedef struct {
+	int epfd;
+	int stop_fd;					// eventfd, wakes up the loop for reactor_stop
+	int running;
+	int num_events;
+	t_reactor_event *events[REACTOR_MAX_EVENTS];
+} t_reactor;
+
+// prototypes
+int reactor_init(t_reactor *);
+int reactor_add_timer(t_reactor *, t_reactor_event *, const char *, long long, long long, t_reactor_handler, void *);
+int reactor_add_fd(t_reactor *, t_reactor_event *, const char *, int, t_reactor_handler, void *);
+void reactor_remove(t_reactor *, t_reactor_event *);
+int reactor_run(t_reactor *);
+void reactor_stop(t_reactor *);
+void reactor_print_stats(t_reactor *, FILE *);
+
+#endif
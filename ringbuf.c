@@ -0,0 +1,180 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ringbuf.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+/**
+* @brief Initialize ring buffer
+* @param ring pointer to ring instance
+* @param name name of ring for statistics
+* @param elem_size size of one element in bytes
+* @param size number of elements, must be a power of 2
+* @return result
+*
+* The ring is lock-free for exactly one producer and one consumer thread.
+* The producer signals new elements on an eventfd, so the consumer can wait
+* for it in its event loop.
+* @date 17.10.2026 born
+*
+*/
+int spsc_ring_init(t_spsc_ring *ring, const char *name, size_t elem_size, unsigned int size)
+{
+	memset(ring, 0, sizeof(t_spsc_ring));
+
+	if (size == 0 || (size & (size - 1)) != 0)
+	{
+		fprintf(stderr, "Ring size must be power of 2 (%s)\n", name);
+		return 1;
+	}
+
+	ring->buf = calloc(size, elem_size);
+	if (ring->buf == NULL)
+	{
+		fprintf(stderr, "Ring allocation failed (%s)\n", name);
+		return 1;
+	}
+
+	ring->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (ring->efd < 0)
+	{
+		fprintf(stderr, "eventfd failed (%s): %s\n", name, strerror(errno));
+		free(ring->buf);
+		return 1;
+	}
+
+	ring->name = name;
+	ring->elem_size = elem_size;
+	ring->size = size;
+	return (0);
+}
+
+/**
+* @brief Put element into ring (producer side)
+* @param ring pointer to ring instance
+* @param elem pointer to element
+* @return 0 if stored, 1 if ring was full and element was dropped
+*
+* @date 17.10.2026 born
+*
+*/
+int spsc_ring_push(t_spsc_ring *ring, const void *elem)
+{
+	unsigned int head = ring->head;
+	unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	uint64_t one = 1;
+
+	if (head - tail >= ring->size)
+	{
+		ring->drops++;
+		return 1;
+	}
+
+	memcpy(ring->buf + (head & (ring->size - 1)) * ring->elem_size, elem, ring->elem_size);
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+	ring->pushed++;
+	if (head + 1 - tail > ring->max_depth)
+		ring->max_depth = head + 1 - tail;
+
+	// wake up consumer
+	if (write(ring->efd, &one, sizeof(one)) != sizeof(one))
+		return 0;
+
+	return (0);
+}
+
+/**
+* @brief Get element from ring (consumer side)
+* @param ring pointer to ring instance
+* @param elem pointer to element buffer
+* @return 0 if element was read, 1 if ring is empty
+*
+* @date 17.10.2026 born
+*
+*/
+int spsc_ring_pop(t_spsc_ring *ring, void *elem)
+{
+	unsigned int tail = ring->tail;
+	unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	if (head == tail)
+		return 1;
+
+	memcpy(elem, ring->buf + (tail & (ring->size - 1)) * ring->elem_size, ring->elem_size);
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+	return (0);
+}
+
+/**
+* @brief Number of elements currently stored in ring
+* @param ring pointer to ring instance
+* @return depth
+*
+* @date 17.10.2026 born
+*
+*/
+unsigned int spsc_ring_depth(t_spsc_ring *ring)
+{
+	return (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+}
+
+/**
+* @brief Acknowledge wakeup of consumer
+* @param ring pointer to ring instance
+* @return
+*
+* Must be called by the consumer before draining the ring with spsc_ring_pop.
+* @date 17.10.2026 born
+*
+*/
+void spsc_ring_clear_event(t_spsc_ring *ring)
+{
+	uint64_t count;
+
+	if (read(ring->efd, &count, sizeof(count)) != sizeof(count))
+		return;
+}
+
+/**
+* @brief Print ring statistics
+* @param ring pointer to ring instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void spsc_ring_print_stats(t_spsc_ring *ring, FILE *fp)
+{
+	fprintf(fp, "  %-8s size: %u depth: %u max depth: %u pushed: %lu drops: %lu\n",
+		ring->name,
+		ring->size,
+		spsc_ring_depth(ring),
+		ring->max_depth,
+		ring->pushed,
+		ring->drops);
+}
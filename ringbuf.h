@@ -0,0 +1,52 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// define struct for bounded single-producer/single-consumer ring buffer
+typedef struct {
+	const char *name;
+	unsigned char *buf;
+	size_t elem_size;
+	unsigned int size;				// number of elements, power of 2
+	int efd;						// eventfd to wake up the consumer
+
+	// written by producer only
+	unsigned int head __attribute__((aligned(64)));
+	unsigned int max_depth;
+	unsigned long pushed;
+	unsigned long drops;
+
+	// written by consumer only
+	unsigned int tail __attribute__((aligned(64)));
+} t_spsc_ring;
+
+// prototypes
+int spsc_ring_init(t_spsc_ring *, const char *, size_t, unsigned int);
+int spsc_ring_push(t_spsc_ring *, const void *);
+int spsc_ring_pop(t_spsc_ring *, void *);
+unsigned int spsc_ring_depth(t_spsc_ring *);
+void spsc_ring_clear_event(t_spsc_ring *);
+void spsc_ring_print_stats(t_spsc_ring *, FILE *);
+
+#endif
@@ -0,0 +1,197 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+#include "rt.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+/**
+* @brief Record result of one setting
+* @param rt pointer to instance
+* @param error errno, 0 if applied
+* @param fmt description of setting, printf format
+* @return error
+*
+* @date 17.10.2026 born
+*
+*/
+static int rt_check(t_rt *rt, int error, const char *fmt, ...)
+{
+	va_list ap;
+	t_rt_check *check;
+
+	if (rt->num_checks >= RT_MAX_CHECKS)
+		return error;
+
+	check = &rt->checks[rt->num_checks++];
+	va_start(ap, fmt);
+	vsnprintf(check->what, sizeof(check->what), fmt, ap);
+	va_end(ap);
+	check->error = error;
+
+	return error;
+}
+
+/**
+* @brief Initialize instance
+* @param rt pointer to instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void rt_init(t_rt *rt)
+{
+	memset(rt, 0, sizeof(t_rt));
+}
+
+/**
+* @brief Touch stack of calling thread, so it is mapped before it is used
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void rt_prefault_stack(void)
+{
+	volatile unsigned char stack[RT_STACK_PREFAULT];
+
+	memset((unsigned char *)stack, 0, sizeof(stack));
+}
+
+/**
+* @brief Lock all memory of the process
+* @param rt pointer to instance
+* @return result
+*
+* Locks current and future mappings, so buffers allocated afterwards are
+* faulted in at allocation. Threads created afterwards get a smaller
+* stack, which is locked completely, instead of the 8 MB default.
+* Call before allocating pipeline buffers and starting threads.
+* @date 17.10.2026 born
+*
+*/
+int rt_lock_memory(t_rt *rt)
+{
+	pthread_attr_t attr;
+	int error = 0;
+
+	if (rt_check(rt, (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) ? errno : 0, "mlockall") != 0)
+		return 1;
+
+	pthread_attr_init(&attr);
+	if (pthread_attr_setstacksize(&attr, RT_THREAD_STACK_SIZE) == 0)
+		error = pthread_setattr_default_np(&attr);
+	pthread_attr_destroy(&attr);
+	rt_check(rt, error, "thread stacks %d kB", RT_THREAD_STACK_SIZE / 1024);
+
+	rt_prefault_stack();
+
+	return (error != 0);
+}
+
+/**
+* @brief Set scheduling policy and CPU affinity of thread
+* @param rt pointer to instance
+* @param tid thread
+* @param name name of thread for report
+* @param priority SCHED_FIFO priority, 0 to keep normal scheduling
+* @param cpu CPU to pin the thread to, -1 for any
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int rt_setup_thread(t_rt *rt, pthread_t tid, const char *name, int priority, int cpu)
+{
+	struct sched_param param;
+	cpu_set_t cpus;
+	int result = 0;
+
+	if (priority > 0)
+	{
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = priority;
+		if (rt_check(rt, pthread_setschedparam(tid, SCHED_FIFO, &param), "%s SCHED_FIFO %d", name, priority) != 0)
+			result = 1;
+	}
+
+	if (cpu >= 0)
+	{
+		CPU_ZERO(&cpus);
+		CPU_SET(cpu, &cpus);
+		if (rt_check(rt, pthread_setaffinity_np(tid, sizeof(cpus), &cpus), "%s on CPU %d", name, cpu) != 0)
+			result = 1;
+	}
+
+	return (result);
+}
+
+/**
+* @brief Number of settings which could not be applied
+* @param rt pointer to instance
+* @return count
+*
+* @date 17.10.2026 born
+*
+*/
+int rt_failed(t_rt *rt)
+{
+	int i, failed = 0;
+
+	for (i = 0; i < rt->num_checks; i++)
+	{
+		if (rt->checks[i].error != 0)
+			failed++;
+	}
+
+	return failed;
+}
+
+/**
+* @brief Print which settings were applied
+* @param rt pointer to instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void rt_print_report(t_rt *rt, FILE *fp)
+{
+	int i;
+
+	fprintf(fp,"Real-time:\n");
+	if (rt->num_checks == 0)
+		fprintf(fp,"  not configured\n");
+
+	for (i = 0; i < rt->num_checks; i++)
+	{
+		if (rt->checks[i].error == 0)
+			fprintf(fp,"  %-28s ok\n", rt->checks[i].what);
+		else
+			fprintf(fp,"  %-28s FAILED: %s\n", rt->checks[i].what, strerror(rt->checks[i].error));
+	}
+}
@@ -0,0 +1,49 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RT_H
+#define RT_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+#define RT_THREAD_STACK_SIZE	(256 * 1024)	// stack of threads created after rt_lock_memory
+#define RT_STACK_PREFAULT		(64 * 1024)		// stack of calling thread touched by rt_lock_memory
+#define RT_MAX_CHECKS			12
+
+// result of one real-time setting for the startup report
+typedef struct {
+	char what[64];
+	int error;						// errno, 0 if applied
+} t_rt_check;
+
+// define struct for real-time settings of the process
+typedef struct {
+	int num_checks;
+	t_rt_check checks[RT_MAX_CHECKS];
+} t_rt;
+
+// prototypes
+void rt_init(t_rt *);
+int rt_lock_memory(t_rt *);
+int rt_setup_thread(t_rt *, pthread_t, const char *, int, int);
+int rt_failed(t_rt *);
+void rt_print_report(t_rt *, FILE *);
+
+#endif
@@ -0,0 +1,71 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <time.h>
+#include "mpu9150.h"
+
+// samples passed between acquisition, fusion and output thread
+
+// raw pressure and voltage values of one measurement cycle
+typedef struct {
+	struct timespec ts;
+	float p_static;			// Pa
+	float p_tep;			// Pa
+	float p_dynamic;		// mbar
+	float voltage;			// V
+} t_pressure_sample;
+
+// filtered values for POV sentences
+typedef struct {
+	struct timespec ts;
+	float p_static;			// Pa
+	float p_dynamic;		// mbar
+	float vario;			// m/s
+	float voltage;			// V
+	char tep_valid;
+} t_vario_sample;
+
+#define IMU_SAMPLE_PACKETS	8		// FIFO packets per raw IMU sample
+
+// raw IMU data, a FIFO read is split into samples of IMU_SAMPLE_PACKETS
+// packets, so a ring slot is not sized for a full FIFO
+typedef struct {
+	struct timespec ts;			// time of last packet
+	short rawGyro[3];			// last packet, also if numPackets is 0
+	short rawAccel[3];
+	long rawQuat[4];
+	unsigned long dmpTimestamp;
+	short rawMag[3];			// read once per FIFO read
+	unsigned long magTimestamp;
+	int numPackets;
+	dmp_packet_t packets[IMU_SAMPLE_PACKETS];
+} t_imu_sample;
+
+// fused attitude for the AHRS output
+typedef struct {
+	struct timespec ts;
+	vector3d_t fusedEuler;
+	quaternion_t fusedQuat;
+	short calibratedAccel[3];
+} t_ahrs_sample;
+
+#endif
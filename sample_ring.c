@@ -0,0 +1,304 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sample_ring.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+* @brief Create shared memory segment for sample ring (producer side)
+* @param ring pointer to ring instance
+* @param name name of POSIX shared memory object, e.g. "/sensord-samples"
+* @param slots number of records, must be a power of 2
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int sample_ring_create(t_sample_ring *ring, const char *name, unsigned int slots)
+{
+	void *p;
+	int fd;
+
+	memset(ring, 0, sizeof(t_sample_ring));
+	ring->name = name;
+	ring->producer = 1;
+
+	if (slots < 2 || (slots & (slots - 1)) != 0)
+	{
+		fprintf(stderr, "Sample ring size must be power of 2 (%s)\n", name);
+		return 1;
+	}
+
+	ring->slots = slots;
+	ring->map_size = sizeof(t_sample_ring_shm) + slots * sizeof(t_sample_record);
+
+	shm_unlink(name);
+	fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+	if (fd < 0)
+	{
+		fprintf(stderr, "could not create shared memory %s: %s\n", name, strerror(errno));
+		return 1;
+	}
+
+	if (ftruncate(fd, ring->map_size) != 0)
+	{
+		fprintf(stderr, "could not size shared memory %s: %s\n", name, strerror(errno));
+		close(fd);
+		shm_unlink(name);
+		return 1;
+	}
+
+	p = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+	{
+		fprintf(stderr, "could not map shared memory %s: %s\n", name, strerror(errno));
+		shm_unlink(name);
+		return 1;
+	}
+
+	ring->shm = p;
+	ring->shm->magic = SAMPLE_RING_MAGIC;
+	ring->shm->version = SAMPLE_RING_VERSION;
+	ring->shm->record_size = sizeof(t_sample_record);
+	ring->shm->slots = slots;
+	ring->shm->pid = getpid();
+
+	return (0);
+}
+
+/**
+* @brief Get next record of ring for writing (producer side)
+* @param ring pointer to ring instance
+* @param type SAMPLE_RECORD_*
+* @return pointer to record in shared memory, NULL if no segment
+*
+* The sample is written directly into the ring, there is no other copy.
+* The record is invalidated first, so a reader still copying the record
+* of the last lap notices it was overwritten. There must be only one
+* producer thread.
+* @date 17.10.2026 born
+*
+*/
+t_sample_record *sample_ring_reserve(t_sample_ring *ring, int type)
+{
+	t_sample_record *rec;
+
+	if (ring->shm == NULL)
+		return NULL;
+
+	// pos - 1 is never expected in this slot, as slots is a power of 2
+	rec = &ring->shm->records[ring->pos & (ring->slots - 1)];
+	__atomic_store_n(&rec->seq, ring->pos - 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	rec->type = type;
+	rec->flags = 0;
+
+	return rec;
+}
+
+/**
+* @brief Publish record returned by sample_ring_reserve (producer side)
+* @param ring pointer to ring instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void sample_ring_commit(t_sample_ring *ring)
+{
+	t_sample_record *rec = &ring->shm->records[ring->pos & (ring->slots - 1)];
+
+	__atomic_store_n(&rec->seq, ring->pos, __ATOMIC_RELEASE);
+	ring->pos++;
+	__atomic_store_n(&ring->shm->head, ring->pos, __ATOMIC_RELEASE);
+
+	ring->records++;
+}
+
+/**
+* @brief Remove shared memory segment (producer side)
+* @param ring pointer to ring instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void sample_ring_destroy(t_sample_ring *ring)
+{
+	if (ring->shm == NULL)
+		return;
+
+	munmap(ring->shm, ring->map_size);
+	shm_unlink(ring->name);
+	ring->shm = NULL;
+}
+
+/**
+* @brief Print sample ring statistics
+* @param ring pointer to ring instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void sample_ring_print_stats(t_sample_ring *ring, FILE *fp)
+{
+	if (ring->producer)
+		fprintf(fp, "  samples  %s slots: %u records: %lu\n",
+			ring->name,
+			ring->slots,
+			ring->records);
+	else
+		fprintf(fp, "  samples  %s records: %lu overruns: %lu lost: %lu\n",
+			ring->name,
+			ring->records,
+			ring->overruns,
+			ring->lost);
+}
+
+/**
+* @brief Attach to sample ring of running sensord (reader side)
+* @param ring pointer to ring instance
+* @param name name of POSIX shared memory object
+* @return result
+*
+* Reading starts with the next record written.
+* @date 17.10.2026 born
+*
+*/
+int sample_ring_attach(t_sample_ring *ring, const char *name)
+{
+	t_sample_ring_shm *shm;
+	struct stat st;
+	void *p;
+	int fd;
+
+	memset(ring, 0, sizeof(t_sample_ring));
+	ring->name = name;
+
+	fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+		return 1;
+
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(t_sample_ring_shm))
+	{
+		close(fd);
+		return 1;
+	}
+
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return 1;
+
+	shm = p;
+	ring->shm = shm;
+	ring->map_size = st.st_size;
+	if (shm->magic != SAMPLE_RING_MAGIC ||
+		shm->version != SAMPLE_RING_VERSION ||
+		shm->record_size != sizeof(t_sample_record) ||
+		shm->slots < 2 || (shm->slots & (shm->slots - 1)) != 0 ||
+		sizeof(t_sample_ring_shm) + (size_t)shm->slots * sizeof(t_sample_record) > ring->map_size)
+	{
+		fprintf(stderr, "shared memory %s has wrong version\n", name);
+		sample_ring_detach(ring);
+		return 1;
+	}
+
+	ring->slots = shm->slots;
+	ring->pos = __atomic_load_n(&shm->head, __ATOMIC_ACQUIRE);
+
+	return (0);
+}
+
+/**
+* @brief Copy next record (reader side)
+* @param ring pointer to ring instance
+* @param rec buffer for record
+* @return 0 if copied, 1 if there is no new record
+*
+* A reader which fell behind skips the overwritten records, they are
+* counted in lost. The producer is never held up by readers.
+* @date 17.10.2026 born
+*
+*/
+int sample_ring_read(t_sample_ring *ring, t_sample_record *rec)
+{
+	t_sample_record *slot;
+	uint32_t head;
+
+	for (;;)
+	{
+		head = __atomic_load_n(&ring->shm->head, __ATOMIC_ACQUIRE);
+		if (head == ring->pos)
+			return 1;
+
+		if (head - ring->pos > ring->slots)
+		{
+			// continue with oldest record still in ring
+			ring->overruns++;
+			ring->lost += head - ring->pos - ring->slots;
+			ring->pos = head - ring->slots;
+		}
+
+		slot = &ring->shm->records[ring->pos & (ring->slots - 1)];
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == ring->pos)
+		{
+			memcpy(rec, slot, sizeof(t_sample_record));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == ring->pos)
+			{
+				ring->pos++;
+				ring->records++;
+				return (0);
+			}
+		}
+
+		// overwritten by the next lap while copying
+		ring->overruns++;
+		ring->lost++;
+		ring->pos++;
+	}
+}
+
+/**
+* @brief Detach from sample ring (reader side)
+* @param ring pointer to ring instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void sample_ring_detach(t_sample_ring *ring)
+{
+	if (ring->shm != NULL)
+		munmap(ring->shm, ring->map_size);
+
+	ring->shm = NULL;
+}
@@ -0,0 +1,116 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// every raw and fused sample in POSIX shared memory, for streaming consumers
+//
+// One producer, any number of readers. Readers map the ring read-only and
+// keep their own cursor, a reader which falls behind by more than the
+// ring size loses the oldest records and is told how many. Readers
+// include this header and build sample_ring.c (link with -lrt).
+
+#define SAMPLE_RING_NAME		"/sensord-samples"
+#define SAMPLE_RING_MAGIC		0x4F565352	// "OVSR"
+#define SAMPLE_RING_VERSION		1
+#define SAMPLE_RING_SLOTS		4096		// default, about 20s at full IMU rate
+
+// record types
+#define SAMPLE_RECORD_PRESSURE	1		// one pressure measurement cycle
+#define SAMPLE_RECORD_DMP		2		// one DMP FIFO packet
+
+// flags of pressure records
+#define SAMPLE_STATIC_VALID		0x01
+#define SAMPLE_TEP_VALID		0x02
+#define SAMPLE_DYNAMIC_VALID	0x04
+#define SAMPLE_VOLTAGE_VALID	0x08
+
+// fixed-size record, 64 bytes, timestamps are CLOCK_MONOTONIC in ns
+typedef struct {
+	uint32_t seq;				// position in ring, written by producer
+	uint16_t type;				// SAMPLE_RECORD_*
+	uint16_t flags;
+	int64_t ts_ns;
+	union {
+		struct {
+			uint32_t static_d1;		// MS5611 ADC values
+			uint32_t static_d2;
+			uint32_t tep_d1;
+			uint32_t tep_d2;
+			float p_static;			// Pa
+			float p_tep;			// Pa
+			float p_dynamic;		// mbar
+			float voltage;			// V
+			int32_t voltage_raw;	// ADS1110
+			uint16_t digoutp;		// AMS5915
+		} pressure;
+		struct {
+			int16_t raw_gyro[3];
+			int16_t raw_accel[3];
+			int32_t raw_quat[4];
+			uint32_t timestamp;		// of DMP, ms
+		} dmp;
+		uint8_t reserved[48];
+	};
+} t_sample_record;
+
+// layout of shared memory segment
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t record_size;		// sizeof(t_sample_record)
+	uint32_t slots;				// number of records, power of 2
+	int32_t pid;				// of producer
+
+	uint32_t head __attribute__((aligned(64)));	// position of next record
+	t_sample_record records[] __attribute__((aligned(64)));
+} t_sample_ring_shm;
+
+// define struct for producer or reader of sample ring
+typedef struct {
+	const char *name;
+	int producer;
+	t_sample_ring_shm *shm;
+	size_t map_size;
+	uint32_t slots;
+	uint32_t pos;				// producer: next record, reader: cursor
+
+	// statistics
+	unsigned long records;		// written or read
+	unsigned long overruns;		// reader fell behind
+	unsigned long lost;			// records overwritten before they were read
+} t_sample_ring;
+
+// prototypes, producer
+int sample_ring_create(t_sample_ring *, const char *, unsigned int);
+t_sample_record *sample_ring_reserve(t_sample_ring *, int);
+void sample_ring_commit(t_sample_ring *);
+void sample_ring_destroy(t_sample_ring *);
+void sample_ring_print_stats(t_sample_ring *, FILE *);
+
+// prototypes, reader
+int sample_ring_attach(t_sample_ring *, const char *);
+int sample_ring_read(t_sample_ring *, t_sample_record *);
+void sample_ring_detach(t_sample_ring *);
+
+#endif
@@ -0,0 +1,346 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "schedule.h"
+#include <string.h>
+#include "ms5611.h"
+#include "timer.h"
+
+static const char *sentence_name[SCHED_SENTENCES] = {"POV_P_Q", "POV_E", "POV_V"};
+static const char *bus_user_name[SCHED_BUS_USERS] = {"pressure", "temp", "imu"};
+
+// one character per tick in the report
+static const char slot_char[] = ".P-";
+
+static int gcd(int a, int b)
+{
+	int t;
+
+	while (b != 0)
+	{
+		t = a % b;
+		a = b;
+		b = t;
+	}
+	return (a);
+}
+
+/**
+* @brief Estimate bus time of one I2C transfer
+* @param msgs number of messages in transfer
+* @param bytes number of data bytes of all messages
+* @param clock SCL clock (Hz)
+* @return time in ns
+*
+* Each message costs an address byte, start and stop condition. Every
+* byte takes 9 clocks including acknowledge.
+* @date 17.10.2026 born
+*
+*/
+static long long transfer_ns(int msgs, int bytes, int clock)
+{
+	return (SCHED_TRANSFER_OVERHEAD_NS + (long long)((msgs + bytes) * 9 + msgs * 2) * NSEC_PER_SEC / clock);
+}
+
+/**
+* @brief Estimate bus time per second of all bus users
+* @param sched pointer to schedule
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+static void estimate_bus_load(t_schedule *sched)
+{
+	const t_schedule_config *c = &sched->config;
+	long long total = 0;
+	int packets;
+	int i;
+
+	// conversion start is one command byte to each MS5611
+	// pressure read covers ADC of both MS5611, AMS5915 and ADS1110
+	sched->start_ns = transfer_ns(2, 2, c->i2c_clock);
+	sched->pressure_read_ns = transfer_ns(6, 2 + 6 + 4 + 3, c->i2c_clock);
+	sched->temp_read_ns = transfer_ns(4, 2 + 6, c->i2c_clock);
+	sched->bus_ns[SCHED_BUS_PRESSURE] = c->pressure_rate * (sched->start_ns + sched->pressure_read_ns);
+	sched->bus_ns[SCHED_BUS_TEMP] = c->temp_rate * (sched->start_ns + sched->temp_read_ns);
+
+	// FIFO count and packets, then magnetometer data
+	sched->bus_ns[SCHED_BUS_IMU] = 0;
+	if (c->imu_sample_rate > 0 && c->imu_poll_rate > 0)
+	{
+		packets = (c->imu_sample_rate + c->imu_poll_rate - 1) / c->imu_poll_rate;
+		sched->bus_ns[SCHED_BUS_IMU] = c->imu_poll_rate *
+			(transfer_ns(2, 1 + 2 + packets * c->imu_packet_length, c->i2c_clock) + transfer_ns(2, 1 + 8, c->i2c_clock));
+	}
+
+	for (i = 0; i < SCHED_BUS_USERS; i++)
+		total += sched->bus_ns[i];
+
+	sched->bus_load = (float)total / NSEC_PER_SEC;
+}
+
+/**
+* @brief Place conversions of the MS5611 pair into the tick table
+* @param sched pointer to schedule
+* @return result
+*
+* Pressure conversions start at a fixed phase, so the samples are evenly
+* spaced. Only the starts are ticks, the read follows when the slower
+* sensor of the pair is done. A temperature conversion is started right
+* after a pressure read, when a refresh is due, so it has to fit between
+* the end of that read and the next pressure conversion. The MS5611 can
+* do only one conversion at a time.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+static int place_conversions(t_schedule *sched)
+{
+	const t_schedule_config *c = &sched->config;
+	long tick_ns = NSEC_PER_SEC / c->tick_rate;
+	long static_ns = ms5611_conversion_ns(c->static_osr);
+	long tep_ns = ms5611_conversion_ns(c->tep_osr);
+	long long period_ns;
+	int pressure_period;
+	int k;
+
+	if (static_ns == 0 || tep_ns == 0)
+	{
+		fprintf(stderr, "Schedule: invalid MS5611 oversampling ratio %d/%d\n", c->static_osr, c->tep_osr);
+		return (1);
+	}
+	sched->conversion_ns = ((static_ns > tep_ns) ? static_ns : tep_ns) + SCHED_CONVERSION_MARGIN_NS;
+
+	// pressure conversion and read, temperature conversion and read
+	sched->pressure_window_ns = sched->conversion_ns + sched->pressure_read_ns;
+	sched->temp_window_ns = sched->start_ns + sched->conversion_ns + sched->temp_read_ns;
+
+	pressure_period = c->tick_rate / c->pressure_rate;
+	period_ns = (long long)pressure_period * tick_ns;
+
+	if (sched->pressure_window_ns + sched->temp_window_ns > period_ns)
+	{
+		fprintf(stderr, "Schedule: pressure and temperature conversion need %.2f ms, only %.2f ms between pressure samples\n",
+			(sched->pressure_window_ns + sched->temp_window_ns) / 1e6, period_ns / 1e6);
+		return (1);
+	}
+
+	// ticks until the pressure read is finished
+	k = (sched->pressure_window_ns + tick_ns - 1) / tick_ns;
+	sched->conversion_ticks = k;
+
+	sched->slots = pressure_period;
+	if (sched->slots > SCHED_MAX_SLOTS)
+	{
+		fprintf(stderr, "Schedule: cycle of %d ticks too long (max. %d)\n", sched->slots, SCHED_MAX_SLOTS);
+		sched->slots = 0;
+		return (1);
+	}
+
+	memset(sched->slot, SCHED_BUSY, k);
+	sched->slot[0] = SCHED_PRESSURE_START;
+
+	return (0);
+}
+
+/**
+* @brief Place output sentences into the output tick table
+* @param sched pointer to schedule
+* @return result
+*
+* The output tick runs with the least common multiple of all sentence
+* rates. Slower sentences get the phase with the fewest other sentences,
+* so the sentences are spread over the ticks.
+* @date 17.10.2026 born
+*
+*/
+static int place_sentences(t_schedule *sched)
+{
+	const t_schedule_config *c = &sched->config;
+	int count[SCHED_MAX_OUTPUT_RATE];
+	int rate, g = 0;
+	int divider, phase, best_phase, load, best_load;
+	int s, t;
+
+	sched->output_rate = 0;
+	for (s = 0; s < SCHED_SENTENCES; s++)
+	{
+		rate = c->sentence_rate[s];
+		if (rate <= 0)
+			continue;
+
+		if (sched->output_rate == 0)
+			sched->output_rate = rate;
+		else
+			sched->output_rate = sched->output_rate / gcd(sched->output_rate, rate) * rate;
+
+		if (sched->output_rate > SCHED_MAX_OUTPUT_RATE)
+		{
+			fprintf(stderr, "Schedule: %s at %d Hz needs output tick of %d Hz (max. %d Hz)\n",
+				sentence_name[s], rate, sched->output_rate, SCHED_MAX_OUTPUT_RATE);
+			sched->output_rate = 0;
+			return (1);
+		}
+		g = gcd(g, rate);
+	}
+
+	if (sched->output_rate == 0)
+		return (0);
+
+	sched->output_slots = sched->output_rate / g;
+	memset(count, 0, sizeof(count));
+
+	for (s = 0; s < SCHED_SENTENCES; s++)
+	{
+		rate = c->sentence_rate[s];
+		if (rate <= 0)
+			continue;
+
+		divider = sched->output_rate / rate;
+		best_phase = 0;
+		best_load = -1;
+		for (phase = 0; phase < divider; phase++)
+		{
+			load = 0;
+			for (t = phase; t < sched->output_slots; t += divider)
+				if (count[t] > load)
+					load = count[t];
+
+			if (best_load < 0 || load < best_load)
+			{
+				best_load = load;
+				best_phase = phase;
+			}
+		}
+
+		for (t = best_phase; t < sched->output_slots; t += divider)
+		{
+			sched->output[t] |= (1 << s);
+			count[t]++;
+		}
+	}
+
+	return (0);
+}
+
+/**
+* @brief Build tick tables from configured rates
+* @param sched pointer to schedule
+* @param config rates and settings
+* @return result
+*
+* Rejects rates which do not fit into the tick raster, pressure periods
+* without room for a temperature conversion and an estimated bus load
+* above SCHED_MAX_BUS_LOAD. The
+* reason is printed to stderr, schedule_print_report shows the details.
+* @date 17.10.2026 born
+*
+*/
+int schedule_compile(t_schedule *sched, const t_schedule_config *config)
+{
+	memset(sched, 0, sizeof(t_schedule));
+	sched->config = *config;
+
+	if (config->tick_rate < 1 || config->tick_rate > 1000)
+	{
+		fprintf(stderr, "Schedule: tick rate %d Hz not in 1..1000\n", config->tick_rate);
+		return (1);
+	}
+
+	if (config->pressure_rate < 1 || config->tick_rate % config->pressure_rate != 0)
+	{
+		fprintf(stderr, "Schedule: pressure rate %d Hz does not divide tick rate %d Hz\n", config->pressure_rate, config->tick_rate);
+		return (1);
+	}
+
+	if (config->temp_rate < 1 || config->temp_rate > config->pressure_rate)
+	{
+		fprintf(stderr, "Schedule: temperature rate %d Hz not in 1..%d Hz\n", config->temp_rate, config->pressure_rate);
+		return (1);
+	}
+
+	if (config->i2c_clock < 1)
+	{
+		fprintf(stderr, "Schedule: invalid I2C clock %d Hz\n", config->i2c_clock);
+		return (1);
+	}
+
+	estimate_bus_load(sched);
+
+	if ((place_conversions(sched) != 0) || (place_sentences(sched) != 0))
+		return (1);
+
+	if (sched->bus_load > SCHED_MAX_BUS_LOAD)
+	{
+		fprintf(stderr, "Schedule: estimated bus load %.0f%% above %.0f%%\n", sched->bus_load * 100, SCHED_MAX_BUS_LOAD * 100);
+		return (1);
+	}
+
+	return (0);
+}
+
+/**
+* @brief Print tick tables and bus utilisation
+* @param sched pointer to schedule
+* @param fp file pointer for output
+* @return
+*
+* In the tick table P is the start of a pressure conversion, - are the
+* ticks until its read is finished.
+* @date 17.10.2026 born
+*
+*/
+void schedule_print_report(t_schedule *sched, FILE *fp)
+{
+	const t_schedule_config *c = &sched->config;
+	int i;
+
+	fprintf(fp,"Schedule:\n");
+	fprintf(fp,"  Tick: \t%d Hz, %d ticks per cycle\n", c->tick_rate, sched->slots);
+	fprintf(fp,"  Pressure: \t%d Hz, OSR static %d TEK %d, read after %.2f ms, %d tick(s) per conversion\n",
+		c->pressure_rate, c->static_osr, c->tep_osr, sched->conversion_ns / 1e6, sched->conversion_ticks);
+	fprintf(fp,"  Temperature: \tmax. %d Hz, after pressure read, %.2f of %.2f ms used\n",
+		c->temp_rate, (sched->pressure_window_ns + sched->temp_window_ns) / 1e6, 1e3 / c->pressure_rate);
+
+	if (sched->slots > 0)
+	{
+		fprintf(fp,"  Ticks: \t");
+		for (i = 0; i < sched->slots; i++)
+		{
+			if (i > 0 && i % 40 == 0)
+				fprintf(fp,"\n        \t");
+			fputc(slot_char[sched->slot[i]], fp);
+		}
+		fprintf(fp,"\n");
+	}
+
+	fprintf(fp,"  Output: \t%d Hz,", sched->output_rate);
+	for (i = 0; i < SCHED_SENTENCES; i++)
+	{
+		if (c->sentence_rate[i] > 0)
+			fprintf(fp," %s %d Hz", sentence_name[i], c->sentence_rate[i]);
+	}
+	fprintf(fp,"\n");
+
+	fprintf(fp,"  Bus load: \t");
+	for (i = 0; i < SCHED_BUS_USERS; i++)
+		fprintf(fp,"%s %.1f%% ", bus_user_name[i], sched->bus_ns[i] * 100.0 / NSEC_PER_SEC);
+	fprintf(fp,"total %.1f%% (max. %.0f%% at %d kHz)\n", sched->bus_load * 100, SCHED_MAX_BUS_LOAD * 100, c->i2c_clock / 1000);
+}
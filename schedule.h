@@ -0,0 +1,92 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdio.h>
+
+#define SCHED_MAX_SLOTS				400		// max. ticks per cycle
+#define SCHED_MAX_OUTPUT_RATE		100		// max. rate of output ticks (Hz)
+#define SCHED_CONVERSION_MARGIN_NS	200000	// added to MS5611 conversion time before read (ns)
+#define SCHED_MAX_BUS_LOAD			0.5		// max. estimated share of I2C bus time
+#define SCHED_I2C_CLOCK				400000	// default SCL clock for bus time estimate (Hz)
+#define SCHED_TRANSFER_OVERHEAD_NS	50000	// syscall and driver time per I2C transfer (ns)
+
+// actions of acquisition ticks, the reads follow at conversion end
+enum {
+	SCHED_IDLE,
+	SCHED_PRESSURE_START,		// start pressure conversion of both MS5611
+	SCHED_BUSY					// conversion or read still running
+};
+
+// output sentences
+enum {
+	SCHED_POV_P_Q,
+	SCHED_POV_E,
+	SCHED_POV_V,
+	SCHED_SENTENCES
+};
+
+// rates and settings the schedule is built from
+typedef struct {
+	int tick_rate;							// Hz
+	int pressure_rate;						// Hz
+	int temp_rate;							// max. rate of temperature refresh (Hz)
+	int static_osr;							// MS5611 oversampling ratios
+	int tep_osr;
+	int sentence_rate[SCHED_SENTENCES];		// Hz, 0 = disabled
+	int imu_sample_rate;					// Hz, 0 = no IMU
+	int imu_poll_rate;						// Hz
+	int imu_packet_length;					// bytes per FIFO packet
+	int i2c_clock;							// SCL clock (Hz)
+} t_schedule_config;
+
+// estimated I2C bus time per second
+enum {
+	SCHED_BUS_PRESSURE,
+	SCHED_BUS_TEMP,
+	SCHED_BUS_IMU,
+	SCHED_BUS_USERS
+};
+
+// compiled slot tables
+typedef struct {
+	t_schedule_config config;
+	long conversion_ns;						// start to read of MS5611 pair, incl. margin
+	long long start_ns;						// estimated bus time of conversion start
+	long long pressure_read_ns;				// estimated bus time of pressure read
+	long long temp_read_ns;					// estimated bus time of temperature read
+	long long pressure_window_ns;			// pressure conversion and read
+	long long temp_window_ns;				// temperature start, conversion and read
+	int conversion_ticks;					// ticks from conversion start to end of read
+	int slots;								// ticks per cycle
+	unsigned char slot[SCHED_MAX_SLOTS];	// SCHED_* action of each tick
+	int output_rate;						// Hz, 0 = no output
+	int output_slots;						// output ticks per cycle
+	unsigned char output[SCHED_MAX_OUTPUT_RATE];	// bit mask of sentences per output tick
+	long long bus_ns[SCHED_BUS_USERS];		// per second
+	float bus_load;
+} t_schedule;
+
+// prototypes
+int schedule_compile(t_schedule *, const t_schedule_config *);
+void schedule_print_report(t_schedule *, FILE *);
+
+#endif
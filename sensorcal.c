@@ -37,6 +37,9 @@
 int g_debug=0;
 FILE *fp_console=NULL;
 int rotation = -1;
+
+// I2C bus shared by EEPROM, AMS5915 and MPU9150
+t_i2c_bus sensor_bus;
 	
 int calibrate_ams5915(t_eeprom_data* data)
 {
@@ -47,7 +50,7 @@ int calibrate_ams5915(t_eeprom_data* data)
 	// open sensor for differential pressure
 	/// @todo remove hardcoded i2c address for differential pressure
 	printf("Open sensor ...");
-	if (ams5915_open(&dynamic_sensor, 0x28) != 0)
+	if (ams5915_open(&dynamic_sensor, &sensor_bus, 0x28) != 0)
 	{
 		printf(" failed !!\n");
 		return 1;
@@ -131,7 +134,7 @@ int calibrate_mpu9150(t_eeprom_data* data, short unsigned int mag)
 		}
 	}
 
-	if (mpu9150_init(i2c_bus, sample_rate, 0, rotation))
+	if (mpu9150_init(i2c_bus, MPU9150_FUSION_DMP, sample_rate, 0, rotation))
 	{
 		printf("Failed to connect to mpu9150\n");
 		return 1;
@@ -288,8 +291,16 @@ int main (int argc, char **argv) {
 	
 	fflush(stdout);
 	
+	// open I2C bus
+	if (i2c_bus_open(&sensor_bus, AHRS_I2C_BUS) != 0)
+	{
+		printf("Open I2C bus failed !!\n");
+		exit(1);
+	}
+	linux_set_i2c_bus_handle(&sensor_bus);
+	
 	// open eeprom object
-	result = eeprom_open(&eeprom, 0x50);
+	result = eeprom_open(&eeprom, &sensor_bus, 0x50);
 	if (result != 0)
 	{
 		printf("No EEPROM found !!\n");
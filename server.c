@@ -0,0 +1,313 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+#include "server.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "def.h"
+
+extern int g_debug;
+extern FILE *fp_console;
+
+/**
+* @brief Open listening socket
+* @param server pointer to server instance
+* @param name name of server for messages and statistics
+* @param address IPv4 address to listen on, 0.0.0.0 for all interfaces
+* @param port TCP port
+* @param reactor event loop of the output thread, clients are added to it
+* @return result
+*
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int server_open(t_server *server, const char *name, const char *address, int port, t_reactor *reactor)
+{
+	struct sockaddr_in addr;
+	int on = 1;
+	int i;
+
+	memset(server, 0, sizeof(t_server));
+	server->name = name;
+	server->port = port;
+	server->reactor = reactor;
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+	{
+		server->clients[i].conn.fd = -1;
+		server->clients[i].server = server;
+	}
+
+	server->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (server->fd < 0)
+	{
+		fprintf(stderr, "could not create socket (%s): %s\n", name, strerror(errno));
+		return 1;
+	}
+
+	setsockopt(server->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = inet_addr(address);
+	addr.sin_port = htons(port);
+
+	if ((bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+		(listen(server->fd, SERVER_BACKLOG) < 0))
+	{
+		fprintf(stderr, "could not listen on %s:%d (%s): %s\n", address, port, name, strerror(errno));
+		close(server->fd);
+		server->fd = -1;
+		return 1;
+	}
+
+	debug_print("listening on %s:%d (%s)\n", address, port, name);
+
+	return (0);
+}
+
+/**
+* @brief Stop watching a client which was dropped
+* @param server pointer to server instance
+* @param client pointer to client slot
+* @return
+*
+* conn_send and conn_poll close the socket of a lost or stalled client.
+* Its event must leave the reactor right away, before the fd number is
+* reused by another socket of the output thread.
+* @date 17.10.2026 born
+*
+*/
+static void server_check_client(t_server *server, t_server_client *client)
+{
+	if (!conn_connected(&client->conn))
+		reactor_remove(server->reactor, &client->event);
+}
+
+/**
+* @brief Event handler for client sockets
+* @param arg pointer to client slot
+* @return
+*
+* Clients are not expected to send anything, input is read and discarded.
+* On EOF or error the client is closed and its slot is free again.
+* @date 17.10.2026 born
+*
+*/
+static void server_client_event(void *arg)
+{
+	t_server_client *client = arg;
+	t_server *server = client->server;
+	char buf[256];
+	ssize_t n;
+
+	// dropped by a failed send earlier in the same round of events
+	if (!conn_connected(&client->conn))
+		return;
+
+	while ((n = recv(client->conn.fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+		;
+
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+		return;
+
+	debug_print("client %d disconnected (%s)\n", (int)(client - server->clients), server->name);
+	server->hangups++;
+	reactor_remove(server->reactor, &client->event);
+	conn_close(&client->conn);
+}
+
+/**
+* @brief Accept all pending clients
+* @param server pointer to server instance
+* @return
+*
+* Called by the output thread when the listening socket is readable.
+* Clients beyond SERVER_MAX_CLIENTS are closed right away. Accepted clients
+* are watched by the output thread event loop, so a slot is freed as soon
+* as its client disconnects.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+void server_accept(t_server *server)
+{
+	t_server_client *client;
+	int fd, i;
+
+	while ((fd = accept4(server->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+		{
+			if (!conn_connected(&server->clients[i].conn))
+				break;
+		}
+
+		if (i == SERVER_MAX_CLIENTS)
+		{
+			server->rejects++;
+			close(fd);
+			continue;
+		}
+
+		client = &server->clients[i];
+		conn_attach(&client->conn, server->name, fd);
+		if (reactor_add_fd(server->reactor, &client->event, server->name, fd, server_client_event, client) != 0)
+		{
+			server->rejects++;
+			conn_close(&client->conn);
+			continue;
+		}
+
+		server->accepts++;
+		debug_print("client %d connected (%s)\n", i, server->name);
+	}
+}
+
+/**
+* @brief Flush output buffers of all clients
+* @param server pointer to server instance
+* @return
+*
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+void server_poll(t_server *server)
+{
+	int i;
+
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+	{
+		if (conn_connected(&server->clients[i].conn))
+		{
+			conn_poll(&server->clients[i].conn);
+			server_check_client(server, &server->clients[i]);
+		}
+	}
+}
+
+/**
+* @brief Number of connected clients
+* @param server pointer to server instance
+* @return count
+*
+* @date 17.10.2026 born
+*
+*/
+int server_clients(t_server *server)
+{
+	int i, count = 0;
+
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+	{
+		if (conn_connected(&server->clients[i].conn))
+			count++;
+	}
+
+	return count;
+}
+
+/**
+* @brief Send data to all clients
+* @param server pointer to server instance
+* @param buf data, one or more complete sentences
+* @param len number of bytes
+* @return 0 if sent to at least one client, 1 if no client is connected
+*
+* The data is encoded once by the caller. Every client has its own output
+* buffer and drop policy, so a slow client does not delay the others.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int server_send(t_server *server, const char *buf, size_t len)
+{
+	int i, result = 1;
+
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+	{
+		if (!conn_connected(&server->clients[i].conn))
+			continue;
+
+		if (conn_send(&server->clients[i].conn, buf, len) == 0)
+			result = 0;
+		server_check_client(server, &server->clients[i]);
+	}
+
+	return result;
+}
+
+/**
+* @brief Close listening socket and all clients
+* @param server pointer to server instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void server_close(t_server *server)
+{
+	int i;
+
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+	{
+		reactor_remove(server->reactor, &server->clients[i].event);
+		conn_close(&server->clients[i].conn);
+	}
+
+	if (server->fd >= 0)
+		close(server->fd);
+
+	server->fd = -1;
+}
+
+/**
+* @brief Print server and client statistics
+* @param server pointer to server instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void server_print_stats(t_server *server, FILE *fp)
+{
+	int i;
+
+	fprintf(fp, "  %-8s port: %d clients: %d accepts: %lu rejects: %lu hangups: %lu\n",
+		server->name,
+		server->port,
+		server_clients(server),
+		server->accepts,
+		server->rejects,
+		server->hangups);
+
+	for (i = 0; i < SERVER_MAX_CLIENTS; i++)
+	{
+		if (conn_connected(&server->clients[i].conn))
+			conn_print_stats(&server->clients[i].conn, fp);
+	}
+}
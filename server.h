@@ -0,0 +1,61 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "conn.h"
+#include "reactor.h"
+
+#define SERVER_MAX_CLIENTS	8
+#define SERVER_BACKLOG		4
+
+// define struct for one client slot, its socket is watched for hangup
+typedef struct {
+	t_conn conn;
+	t_reactor_event event;
+	void *server;					// owning t_server
+} t_server_client;
+
+// define struct for listening socket and its clients, managed by the output thread
+typedef struct {
+	const char *name;
+	int fd;
+	int port;
+	t_reactor *reactor;				// output thread event loop, watches the clients
+	t_server_client clients[SERVER_MAX_CLIENTS];
+
+	// statistics
+	unsigned long accepts;
+	unsigned long rejects;			// clients closed, all slots in use
+	unsigned long hangups;			// clients which closed their connection
+} t_server;
+
+// prototypes
+int server_open(t_server *, const char *, const char *, int, t_reactor *);
+void server_accept(t_server *);
+void server_poll(t_server *);
+int server_clients(t_server *);
+int server_send(t_server *, const char *, size_t);
+void server_close(t_server *);
+void server_print_stats(t_server *, FILE *);
+
+#endif
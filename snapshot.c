@@ -0,0 +1,275 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "snapshot.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+* @brief Create shared memory segment for snapshot (writer side)
+* @param snap pointer to snapshot instance
+* @param name name of POSIX shared memory object, e.g. "/sensord"
+* @return result
+*
+* A segment left over by a crashed sensord is removed first. Readers still
+* attached to it keep the old mapping and see its timestamps stop.
+* @date 17.10.2026 born
+*
+*/
+int snapshot_create(t_snapshot *snap, const char *name)
+{
+	void *p;
+	int fd;
+
+	memset(snap, 0, sizeof(t_snapshot));
+	snap->name = name;
+	snap->writer = 1;
+
+	shm_unlink(name);
+	fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+	if (fd < 0)
+	{
+		fprintf(stderr, "could not create shared memory %s: %s\n", name, strerror(errno));
+		return 1;
+	}
+
+	if (ftruncate(fd, sizeof(t_snapshot_shm)) != 0)
+	{
+		fprintf(stderr, "could not size shared memory %s: %s\n", name, strerror(errno));
+		close(fd);
+		shm_unlink(name);
+		return 1;
+	}
+
+	p = mmap(NULL, sizeof(t_snapshot_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+	{
+		fprintf(stderr, "could not map shared memory %s: %s\n", name, strerror(errno));
+		shm_unlink(name);
+		return 1;
+	}
+
+	snap->shm = p;
+	snap->shm->magic = SNAPSHOT_MAGIC;
+	snap->shm->version = SNAPSHOT_VERSION;
+	snap->shm->size = sizeof(t_snapshot_shm);
+	snap->shm->pid = getpid();
+
+	return (0);
+}
+
+/**
+* @brief Start update of snapshot (writer side)
+* @param snap pointer to snapshot instance
+* @return pointer to data in shared memory, NULL if no segment
+*
+* Only fields which changed need to be written. There must be only one
+* writer thread.
+* @date 17.10.2026 born
+*
+*/
+t_snapshot_data *snapshot_begin(t_snapshot *snap)
+{
+	if (snap->shm == NULL)
+		return NULL;
+
+	// odd sequence tells readers to retry
+	snap->seq = snap->shm->seq + 1;
+	__atomic_store_n(&snap->shm->seq, snap->seq, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	return (&snap->shm->data);
+}
+
+/**
+* @brief Finish update of snapshot (writer side)
+* @param snap pointer to snapshot instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void snapshot_end(t_snapshot *snap)
+{
+	__atomic_store_n(&snap->shm->seq, snap->seq + 1, __ATOMIC_RELEASE);
+	snap->updates++;
+}
+
+/**
+* @brief Remove shared memory segment (writer side)
+* @param snap pointer to snapshot instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void snapshot_destroy(t_snapshot *snap)
+{
+	if (snap->shm == NULL)
+		return;
+
+	munmap(snap->shm, sizeof(t_snapshot_shm));
+	shm_unlink(snap->name);
+	snap->shm = NULL;
+}
+
+/**
+* @brief Print snapshot statistics
+* @param snap pointer to snapshot instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void snapshot_print_stats(t_snapshot *snap, FILE *fp)
+{
+	if (snap->writer)
+		fprintf(fp, "  snapshot %s size: %d updates: %lu\n",
+			snap->name,
+			(int)sizeof(t_snapshot_shm),
+			snap->updates);
+	else
+		fprintf(fp, "  snapshot %s reads: %lu retries: %lu\n",
+			snap->name,
+			snap->reads,
+			snap->retries);
+}
+
+/**
+* @brief Attach to snapshot of running sensord (reader side)
+* @param snap pointer to snapshot instance
+* @param name name of POSIX shared memory object
+* @return result
+*
+* @date 17.10.2026 born
+*
+*/
+int snapshot_attach(t_snapshot *snap, const char *name)
+{
+	struct stat st;
+	void *p;
+	int fd;
+
+	memset(snap, 0, sizeof(t_snapshot));
+	snap->name = name;
+
+	fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+		return 1;
+
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(t_snapshot_shm))
+	{
+		close(fd);
+		return 1;
+	}
+
+	p = mmap(NULL, sizeof(t_snapshot_shm), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return 1;
+
+	snap->shm = p;
+	if (snap->shm->magic != SNAPSHOT_MAGIC ||
+		snap->shm->version != SNAPSHOT_VERSION ||
+		snap->shm->size != sizeof(t_snapshot_shm))
+	{
+		fprintf(stderr, "shared memory %s has wrong version\n", name);
+		snapshot_detach(snap);
+		return 1;
+	}
+
+	return (0);
+}
+
+/**
+* @brief Copy consistent snapshot (reader side)
+* @param snap pointer to snapshot instance
+* @param data buffer for snapshot
+* @return 0 if copied, 1 if nothing was published yet or the writer hangs
+*
+* The copy is retried while the writer updates the data, this costs no
+* syscall and never blocks the writer.
+* @date 17.10.2026 born
+*
+*/
+int snapshot_read(t_snapshot *snap, t_snapshot_data *data)
+{
+	uint32_t seq;
+	int i;
+
+	for (i = 0; i < SNAPSHOT_MAX_RETRIES; i++)
+	{
+		seq = __atomic_load_n(&snap->shm->seq, __ATOMIC_ACQUIRE);
+		if (seq == 0)
+			return 1;
+
+		if ((seq & 1) == 0)
+		{
+			memcpy(data, &snap->shm->data, sizeof(t_snapshot_data));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if (__atomic_load_n(&snap->shm->seq, __ATOMIC_RELAXED) == seq)
+			{
+				snap->seq = seq;
+				snap->reads++;
+				return (0);
+			}
+		}
+
+		snap->retries++;
+	}
+
+	return 1;
+}
+
+/**
+* @brief Check for update since last read (reader side)
+* @param snap pointer to snapshot instance
+* @return 1 if the writer started an update since the last snapshot_read
+*
+* @date 17.10.2026 born
+*
+*/
+int snapshot_changed(t_snapshot *snap)
+{
+	return (__atomic_load_n(&snap->shm->seq, __ATOMIC_ACQUIRE) != snap->seq);
+}
+
+/**
+* @brief Detach from snapshot (reader side)
+* @param snap pointer to snapshot instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void snapshot_detach(t_snapshot *snap)
+{
+	if (snap->shm != NULL)
+		munmap(snap->shm, sizeof(t_snapshot_shm));
+
+	snap->shm = NULL;
+}
@@ -0,0 +1,102 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// latest fused state in POSIX shared memory, for consumers on the same board
+//
+// Readers include this header and build snapshot.c (link with -lrt). They
+// only need snapshot_attach, snapshot_read, snapshot_changed and
+// snapshot_detach. Reading takes no lock and no syscall.
+
+#define SNAPSHOT_NAME			"/sensord"
+#define SNAPSHOT_MAGIC			0x4F565353	// "OVSS"
+#define SNAPSHOT_VERSION		1
+#define SNAPSHOT_MAX_RETRIES	1000		// reader gives up, if writer died while writing
+
+// flags
+#define SNAPSHOT_PRESSURE_VALID	0x01	// pressure values were published
+#define SNAPSHOT_TEP_VALID		0x02	// TE pressure in range, vario valid
+#define SNAPSHOT_VARIO_IMU		0x04	// vario from baro-inertial filter
+#define SNAPSHOT_IMU_VALID		0x08	// attitude values were published
+
+// published values, all timestamps are CLOCK_MONOTONIC in ns
+typedef struct {
+	uint32_t flags;
+
+	// pressure fusion
+	int64_t pressure_ts_ns;
+	float p_static;				// Pa
+	float p_dynamic;			// mbar
+	float vkf_x_abs;			// TE pressure of pressure only filter, hPa
+	float vkf_x_vel;			// rate of change, hPa/s
+	float vario;				// m/s
+	float voltage;				// V
+
+	// IMU fusion
+	int64_t imu_ts_ns;
+	float fused_euler[3];		// roll, pitch, yaw (rad)
+	float fused_quat[4];
+	float vert_accel;			// earth frame, up, without gravity (m/s^2)
+	int16_t calibrated_accel[3];
+} t_snapshot_data;
+
+// layout of shared memory segment
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;				// sizeof(t_snapshot_shm)
+	int32_t pid;				// of writer
+
+	// odd while the writer updates data
+	uint32_t seq __attribute__((aligned(64)));
+	t_snapshot_data data;
+} t_snapshot_shm;
+
+// define struct for writer or reader of snapshot
+typedef struct {
+	const char *name;
+	int writer;
+	t_snapshot_shm *shm;
+	uint32_t seq;				// writer: seq of begin, reader: seq of last read
+
+	// statistics
+	unsigned long updates;
+	unsigned long reads;
+	unsigned long retries;
+} t_snapshot;
+
+// prototypes, writer
+int snapshot_create(t_snapshot *, const char *);
+t_snapshot_data *snapshot_begin(t_snapshot *);
+void snapshot_end(t_snapshot *);
+void snapshot_destroy(t_snapshot *);
+void snapshot_print_stats(t_snapshot *, FILE *);
+
+// prototypes, reader
+int snapshot_attach(t_snapshot *, const char *);
+int snapshot_read(t_snapshot *, t_snapshot_data *);
+int snapshot_changed(t_snapshot *);
+void snapshot_detach(t_snapshot *);
+
+#endif
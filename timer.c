@@ -17,6 +17,61 @@
     along with this program; if not, see <http://www.gnu.org/licenses/>.	
 */
 
+#include <time.h>
+#include "timer.h"
+
+/**
+* @brief Get current time of the monotonic clock
+* @param ts pointer to timespec for result
+* @return 
+* 
+* All scheduling and sample timestamps in sensord are based on
+* CLOCK_MONOTONIC, so they are not affected by setting the system time.
+* @date 17.10.2026 born
+*
+*/ 
+void timer_now(struct timespec *ts)
+{
+	clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+/**
+* @brief Add nanoseconds to timespec
+* @param ts pointer to timespec
+* @param ns nanoseconds to add (may be negative)
+* @return 
+* 
+* @date 17.10.2026 born
+*
+*/ 
+void timespec_add_ns(struct timespec *ts, long long ns)
+{
+	ns += ts->tv_nsec;
+	ts->tv_sec += ns / NSEC_PER_SEC;
+	ts->tv_nsec = ns % NSEC_PER_SEC;
+	
+	if (ts->tv_nsec < 0)
+	{
+		ts->tv_sec--;
+		ts->tv_nsec += NSEC_PER_SEC;
+	}
+}
+
+/**
+* @brief Difference of two timespecs
+* @param a pointer to timespec
+* @param b pointer to timespec
+* @return a - b in nanoseconds
+* 
+* @date 17.10.2026 born
+*
+*/ 
+long long timespec_diff_ns(const struct timespec *a, const struct timespec *b)
+{
+	return ((long long)(a->tv_sec - b->tv_sec) * NSEC_PER_SEC) + (a->tv_nsec - b->tv_nsec);
+}
+
+
 
 /*
 //Set the timer  
@@ -15,4 +15,18 @@
 
     You should have received a copy of the GNU General Public License
     along with this program; if not, see <http://www.gnu.org/licenses/>.	
-*/
\ No newline at end of file
+*/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <time.h>
+
+#define NSEC_PER_SEC	1000000000L
+
+// prototypes
+void timer_now(struct timespec *);
+void timespec_add_ns(struct timespec *, long long);
+long long timespec_diff_ns(const struct timespec *, const struct timespec *);
+
+#endif
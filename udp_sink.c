@@ -0,0 +1,198 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "udp_sink.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include "nmea.h"
+#include "def.h"
+
+extern int g_debug;
+extern FILE *fp_console;
+
+/**
+* @brief Open UDP output
+* @param sink pointer to sink instance
+* @param name name of sink for messages and statistics
+* @param address destination, unicast or multicast group
+* @param port destination port
+* @param ttl TTL (hops) of the datagrams
+* @param interface name of network interface for multicast, "any" for default route
+* @return result
+*
+* Multicast datagrams are looped back, so receivers on the same board
+* get them, too.
+* @date 17.10.2026 born
+*
+*/
+int udp_sink_open(t_udp_sink *sink, const char *name, const char *address, int port, int ttl, const char *interface)
+{
+	struct ip_mreqn mreq;
+	unsigned char loop = 1;
+	unsigned char mttl = ttl;
+
+	memset(sink, 0, sizeof(t_udp_sink));
+	sink->name = name;
+
+	sink->addr.sin_family = AF_INET;
+	sink->addr.sin_port = htons(port);
+	if (inet_aton(address, &sink->addr.sin_addr) == 0)
+	{
+		fprintf(stderr, "invalid UDP address %s (%s)\n", address, name);
+		sink->fd = -1;
+		return 1;
+	}
+
+	sink->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (sink->fd < 0)
+	{
+		fprintf(stderr, "could not create UDP socket (%s): %s\n", name, strerror(errno));
+		return 1;
+	}
+
+	if (IN_MULTICAST(ntohl(sink->addr.sin_addr.s_addr)))
+	{
+		setsockopt(sink->fd, IPPROTO_IP, IP_MULTICAST_TTL, &mttl, sizeof(mttl));
+		setsockopt(sink->fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+		if (strcmp(interface, "any") != 0)
+		{
+			memset(&mreq, 0, sizeof(mreq));
+			mreq.imr_ifindex = if_nametoindex(interface);
+			if (mreq.imr_ifindex == 0 ||
+				setsockopt(sink->fd, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof(mreq)) < 0)
+			{
+				fprintf(stderr, "could not use interface %s for multicast (%s): %s\n", interface, name, strerror(errno));
+				udp_sink_close(sink);
+				return 1;
+			}
+		}
+	}
+	else
+	{
+		setsockopt(sink->fd, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl));
+	}
+
+	debug_print("sending UDP to %s:%d (%s)\n", address, port, name);
+
+	return (0);
+}
+
+/**
+* @brief Check if UDP output is open
+* @param sink pointer to sink instance
+* @return 1 if open
+*
+* @date 17.10.2026 born
+*
+*/
+int udp_sink_active(t_udp_sink *sink)
+{
+	return (sink->fd >= 0);
+}
+
+/**
+* @brief Send sentences as one datagram with sequence number
+* @param sink pointer to sink instance
+* @param buf complete sentences
+* @param len number of bytes
+* @return result
+*
+* Every datagram starts with a $POVSEQ sentence, receivers detect lost
+* datagrams by gaps in the sequence numbers. Parsers which do not know
+* the sentence skip it. A datagram which could not be sent still uses up
+* its number, it is not retried as the next tick brings newer values.
+* @date 17.10.2026 born
+*
+*/
+int udp_sink_send(t_udp_sink *sink, const char *buf, size_t len)
+{
+	char seq_sentence[NMEA_SEQ_SIZE];
+	struct iovec iov[2];
+	struct msghdr msg;
+	ssize_t n;
+
+	if (sink->fd < 0)
+		return 1;
+
+	iov[0].iov_base = seq_sentence;
+	iov[0].iov_len = Compose_Sequence(seq_sentence, sink->seq++);
+	iov[1].iov_base = (void *)buf;
+	iov[1].iov_len = len;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &sink->addr;
+	msg.msg_namelen = sizeof(sink->addr);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	n = sendmsg(sink->fd, &msg, MSG_DONTWAIT);
+	if (n < 0)
+	{
+		sink->errors++;
+		return 1;
+	}
+
+	sink->datagrams++;
+	sink->bytes += n;
+
+	return (0);
+}
+
+/**
+* @brief Close UDP output
+* @param sink pointer to sink instance
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void udp_sink_close(t_udp_sink *sink)
+{
+	if (sink->fd >= 0)
+		close(sink->fd);
+
+	sink->fd = -1;
+}
+
+/**
+* @brief Print UDP output statistics
+* @param sink pointer to sink instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void udp_sink_print_stats(t_udp_sink *sink, FILE *fp)
+{
+	fprintf(fp, "  %-8s udp %s:%d datagrams: %lu errors: %lu sent: %llukB\n",
+		sink->name,
+		inet_ntoa(sink->addr.sin_addr),
+		ntohs(sink->addr.sin_port),
+		sink->datagrams,
+		sink->errors,
+		sink->bytes / 1024);
+}
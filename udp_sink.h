@@ -0,0 +1,47 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UDP_SINK_H
+#define UDP_SINK_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <netinet/in.h>
+
+// define struct for UDP output, unicast or multicast
+typedef struct {
+	const char *name;
+	int fd;
+	struct sockaddr_in addr;
+	unsigned long seq;				// sequence number of next datagram
+
+	// statistics
+	unsigned long datagrams;
+	unsigned long errors;
+	unsigned long long bytes;
+} t_udp_sink;
+
+// prototypes
+int udp_sink_open(t_udp_sink *, const char *, const char *, int, int, const char *);
+int udp_sink_active(t_udp_sink *);
+int udp_sink_send(t_udp_sink *, const char *, size_t);
+void udp_sink_close(t_udp_sink *);
+void udp_sink_print_stats(t_udp_sink *, FILE *);
+
+#endif
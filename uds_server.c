@@ -0,0 +1,393 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+#include "uds_server.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "conn.h"
+#include "timer.h"
+#include "def.h"
+
+extern int g_debug;
+extern FILE *fp_console;
+
+/**
+* @brief Open listening Unix domain socket
+* @param server pointer to server instance
+* @param name name of server for messages and statistics
+* @param path socket path, an old socket file is replaced
+* @param allow_uid user allowed besides root and the user and group of sensord, -1 for none
+* @param reactor event loop of the output thread, clients are added to it
+* @return result
+*
+* SOCK_SEQPACKET keeps the message boundaries, every send is received
+* as one message.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int uds_server_open(t_uds_server *server, const char *name, const char *path, int allow_uid, t_reactor *reactor)
+{
+	struct sockaddr_un addr;
+	int i;
+
+	memset(server, 0, sizeof(t_uds_server));
+	server->name = name;
+	server->fd = -1;
+	server->allow_uid = allow_uid;
+	server->reactor = reactor;
+	for (i = 0; i < UDS_MAX_CLIENTS; i++)
+	{
+		server->clients[i].fd = -1;
+		server->clients[i].server = server;
+	}
+
+	if (strlen(path) >= sizeof(addr.sun_path))
+	{
+		fprintf(stderr, "socket path too long (%s): %s\n", name, path);
+		return 1;
+	}
+	strcpy(server->path, path);
+
+	server->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (server->fd < 0)
+	{
+		fprintf(stderr, "could not create socket (%s): %s\n", name, strerror(errno));
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	unlink(path);
+	if ((bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+		(chmod(path, 0660) < 0) ||
+		(listen(server->fd, UDS_BACKLOG) < 0))
+	{
+		fprintf(stderr, "could not listen on %s (%s): %s\n", path, name, strerror(errno));
+		close(server->fd);
+		server->fd = -1;
+		return 1;
+	}
+
+	debug_print("listening on %s (%s)\n", path, name);
+
+	return (0);
+}
+
+/**
+* @brief Check credentials of new client
+* @param server pointer to server instance
+* @param fd socket of client
+* @param client client slot, gets uid and pid of peer
+* @return 1 if allowed
+*
+* @date 17.10.2026 born
+*
+*/
+static int uds_peer_allowed(t_uds_server *server, int fd, t_uds_client *client)
+{
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
+		return 0;
+
+	client->uid = cred.uid;
+	client->pid = cred.pid;
+
+	return (cred.uid == 0 || cred.uid == geteuid() || cred.gid == getegid() ||
+		(server->allow_uid >= 0 && cred.uid == (uid_t)server->allow_uid));
+}
+
+/**
+* @brief Close client
+* @param client pointer to client
+* @return
+*
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+static void uds_client_close(t_uds_client *client)
+{
+	t_uds_server *server = client->server;
+
+	reactor_remove(server->reactor, &client->event);
+
+	if (client->fd >= 0)
+		close(client->fd);
+
+	client->fd = -1;
+}
+
+/**
+* @brief Event handler for client sockets
+* @param arg pointer to client
+* @return
+*
+* Clients are not expected to send anything, messages are read and
+* discarded. On EOF or error the client is closed and its slot is free
+* again.
+* @date 17.10.2026 born
+*
+*/
+static void uds_client_event(void *arg)
+{
+	t_uds_client *client = arg;
+	t_uds_server *server = client->server;
+	char buf[256];
+	ssize_t n;
+
+	while ((n = recv(client->fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+		;
+
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+		return;
+
+	debug_print("client %d disconnected (%s)\n", (int)(client - server->clients), server->name);
+	server->hangups++;
+	uds_client_close(client);
+}
+
+/**
+* @brief Accept all pending clients
+* @param server pointer to server instance
+* @return
+*
+* Called by the output thread when the listening socket is readable.
+* Clients beyond UDS_MAX_CLIENTS or with credentials not allowed are
+* closed right away. Accepted clients are watched by the output thread
+* event loop, so a slot is freed as soon as its client disconnects.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+void uds_server_accept(t_uds_server *server)
+{
+	t_uds_client *client;
+	int sndbuf = UDS_SNDBUF;
+	int fd, i;
+
+	while ((fd = accept4(server->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		for (i = 0; i < UDS_MAX_CLIENTS; i++)
+		{
+			if (server->clients[i].fd < 0)
+				break;
+		}
+
+		if (i == UDS_MAX_CLIENTS)
+		{
+			server->rejects++;
+			close(fd);
+			continue;
+		}
+
+		client = &server->clients[i];
+		memset(client, 0, sizeof(t_uds_client));
+		client->fd = -1;
+		client->server = server;
+
+		if (!uds_peer_allowed(server, fd, client))
+		{
+			server->denied++;
+			debug_print("client uid %d pid %d denied (%s)\n", (int)client->uid, (int)client->pid, server->name);
+			close(fd);
+			continue;
+		}
+
+		setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+		if (reactor_add_fd(server->reactor, &client->event, server->name, fd, uds_client_event, client) != 0)
+		{
+			server->rejects++;
+			close(fd);
+			continue;
+		}
+
+		client->fd = fd;
+		server->accepts++;
+		debug_print("client %d uid %d pid %d connected (%s)\n", i, (int)client->uid, (int)client->pid, server->name);
+	}
+}
+
+/**
+* @brief Number of connected clients
+* @param server pointer to server instance
+* @return count
+*
+* A server which is not open has no clients, its slots are not
+* initialised.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int uds_server_clients(t_uds_server *server)
+{
+	int i, count = 0;
+
+	if (server->fd < 0)
+		return 0;
+
+	for (i = 0; i < UDS_MAX_CLIENTS; i++)
+	{
+		if (server->clients[i].fd >= 0)
+			count++;
+	}
+
+	return count;
+}
+
+/**
+* @brief Send data as one message to all clients
+* @param server pointer to server instance
+* @param buf data, one or more complete sentences
+* @param len number of bytes
+* @return 0 if sent to at least one client, 1 if no client took it
+*
+* A message the socket does not take is dropped as a whole, there is no
+* output buffer. A client which did not take any message for
+* CONN_STALL_NS is closed, like a stalled TCP client.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+int uds_server_send(t_uds_server *server, const char *buf, size_t len)
+{
+	t_uds_client *client;
+	struct timespec now;
+	int i, result = 1;
+
+	if (server->fd < 0)
+		return 1;
+
+	for (i = 0; i < UDS_MAX_CLIENTS; i++)
+	{
+		client = &server->clients[i];
+		if (client->fd < 0)
+			continue;
+
+		if (send(client->fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)len)
+		{
+			client->messages++;
+			client->bytes += len;
+			client->stalled = 0;
+			result = 0;
+			continue;
+		}
+
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+		{
+			debug_print("client %d disconnected (%s): %s\n", i, server->name, strerror(errno));
+			uds_client_close(client);
+			continue;
+		}
+
+		client->drops++;
+		timer_now(&now);
+		if (!client->stalled)
+		{
+			client->stalled = 1;
+			client->stalled_since = now;
+		}
+		else if (timespec_diff_ns(&now, &client->stalled_since) > CONN_STALL_NS)
+		{
+			server->stalls++;
+			debug_print("client %d stalled (%s)\n", i, server->name);
+			uds_client_close(client);
+		}
+	}
+
+	return result;
+}
+
+/**
+* @brief Close listening socket and all clients
+* @param server pointer to server instance
+* @return
+*
+* Does nothing if the server is not open, so it may be called again or
+* for a server which only had its fd set to -1.
+* @date 17.10.2026 born
+* @date 17.10.2026 revised
+*
+*/
+void uds_server_close(t_uds_server *server)
+{
+	int i;
+
+	// clients are only valid while listening
+	if (server->fd < 0)
+		return;
+
+	for (i = 0; i < UDS_MAX_CLIENTS; i++)
+		uds_client_close(&server->clients[i]);
+
+	close(server->fd);
+	unlink(server->path);
+
+	server->fd = -1;
+}
+
+/**
+* @brief Print server and client statistics
+* @param server pointer to server instance
+* @param fp file pointer for output
+* @return
+*
+* @date 17.10.2026 born
+*
+*/
+void uds_server_print_stats(t_uds_server *server, FILE *fp)
+{
+	t_uds_client *client;
+	int i;
+
+	fprintf(fp, "  %-8s uds %s clients: %d accepts: %lu rejects: %lu denied: %lu stalls: %lu hangups: %lu\n",
+		server->name,
+		server->path,
+		uds_server_clients(server),
+		server->accepts,
+		server->rejects,
+		server->denied,
+		server->stalls,
+		server->hangups);
+
+	for (i = 0; i < UDS_MAX_CLIENTS; i++)
+	{
+		client = &server->clients[i];
+		if (client->fd < 0)
+			continue;
+
+		fprintf(fp, "  %-8s uid: %d pid: %d messages: %lu drops: %lu sent: %llukB\n",
+			server->name,
+			(int)client->uid,
+			(int)client->pid,
+			client->messages,
+			client->drops,
+			client->bytes / 1024);
+	}
+}
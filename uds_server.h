@@ -0,0 +1,75 @@
+/*
+	sensord - Sensor Interface for XCSoar Glide Computer - http://www.openvario.org/
+    Copyright (C) 2014  The openvario project
+    A detailed list of copyright holders can be found in the file "AUTHORS"
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UDS_SERVER_H
+#define UDS_SERVER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/types.h>
+#include "reactor.h"
+
+#define UDS_MAX_CLIENTS		8
+#define UDS_BACKLOG			4
+#define UDS_PATH_SIZE		108				// sizeof(sun_path)
+#define UDS_SNDBUF			16384			// socket send buffer, a few dozen messages
+
+// define struct for client of Unix domain socket
+typedef struct {
+	int fd;
+	uid_t uid;
+	pid_t pid;
+	int stalled;					// last message was dropped
+	struct timespec stalled_since;
+	t_reactor_event event;			// watches the socket for hangup
+	void *server;					// owning t_uds_server
+
+	// statistics
+	unsigned long messages;
+	unsigned long drops;			// messages the socket did not take
+	unsigned long long bytes;
+} t_uds_client;
+
+// define struct for SOCK_SEQPACKET listening socket and its clients, managed by the output thread
+typedef struct {
+	const char *name;
+	char path[UDS_PATH_SIZE];
+	int fd;
+	int allow_uid;					// allowed in addition to root and own user/group, -1 for none
+	t_reactor *reactor;				// output thread event loop, watches the clients
+	t_uds_client clients[UDS_MAX_CLIENTS];
+
+	// statistics
+	unsigned long accepts;
+	unsigned long rejects;			// clients closed, all slots in use
+	unsigned long denied;			// clients closed, credentials not allowed
+	unsigned long stalls;			// clients closed, did not read
+	unsigned long hangups;			// clients which closed their connection
+} t_uds_server;
+
+// prototypes
+int uds_server_open(t_uds_server *, const char *, const char *, int, t_reactor *);
+void uds_server_accept(t_uds_server *);
+int uds_server_clients(t_uds_server *);
+int uds_server_send(t_uds_server *, const char *, size_t);
+void uds_server_close(t_uds_server *);
+void uds_server_print_stats(t_uds_server *, FILE *);
+
+#endif